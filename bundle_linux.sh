@@ -13,6 +13,7 @@ cp ./resources/*.wav ./build/VectorAudio.AppDir/usr/share/vectoraudio/
 cp ./resources/*.ttf ./build/VectorAudio.AppDir/usr/share/vectoraudio/
 cp ./resources/LICENSE.txt ./build/VectorAudio.AppDir/usr/share/vectoraudio/
 cp ./resources/airports.json ./build/VectorAudio.AppDir/usr/share/vectoraudio/
+cp ./build/airports.bin ./build/VectorAudio.AppDir/usr/share/vectoraudio/
 cp ./resources/icon_mac.png ./build/VectorAudio.AppDir/vectoraudio.png
 cp ./resources/icon_mac.png ./build/VectorAudio.AppDir/.DirIcon
 cp ./resources/icon_mac.png ./build/VectorAudio.AppDir/usr/share/vectoraudio/
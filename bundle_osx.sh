@@ -21,6 +21,7 @@ cp resources/*.wav build/VectorAudio.app/Contents/Resources
 cp resources/*.ttf build/VectorAudio.app/Contents/Resources
 cp resources/LICENSE.txt build/VectorAudio.app/Contents/Resources
 cp resources/airports.json build/VectorAudio.app/Contents/Resources
+cp build/airports.bin build/VectorAudio.app/Contents/Resources
 cp resources/VectorAudio.icns build/VectorAudio.app/Contents/Resources
 cp resources/icon_mac.png build/VectorAudio.app/Contents/Resources
 
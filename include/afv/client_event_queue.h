@@ -0,0 +1,273 @@
+#pragma once
+#include "afv-native/event.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vector_audio::afv {
+
+/**
+ * Bounded multi producer, single consumer queue that never blocks.
+ *
+ * Each cell carries a sequence number telling producers and the consumer
+ * whose turn it is, so pushing and popping are a handful of atomic
+ * operations. When the queue is full the new value is dropped and counted
+ * instead of waiting for the consumer.
+ */
+template <typename T, size_t Capacity> class MpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+        "Capacity must be a power of two");
+
+public:
+    MpscRing()
+    {
+        for (size_t i = 0; i < Capacity; i++) {
+            pCells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    /**
+     * Any thread. Returns false and counts an overflow if the queue is full.
+     */
+    bool tryPush(T value)
+    {
+        size_t pos = pEnqueuePos.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        while (true) {
+            cell = &pCells[pos & (Capacity - 1)];
+            const size_t sequence
+                = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence)
+                - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (pEnqueuePos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                pOverflows.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = pEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        const size_t depth
+            = pos + 1 - pDequeuePos.load(std::memory_order_relaxed);
+        size_t highWater = pHighWater.load(std::memory_order_relaxed);
+        while (depth > highWater
+            && !pHighWater.compare_exchange_weak(
+                highWater, depth, std::memory_order_relaxed)) { }
+        return true;
+    }
+
+    /**
+     * Consumer thread only.
+     */
+    bool tryPop(T& out)
+    {
+        const size_t pos = pDequeuePos.load(std::memory_order_relaxed);
+        Cell& cell = pCells[pos & (Capacity - 1)];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<std::ptrdiff_t>(sequence)
+                - static_cast<std::ptrdiff_t>(pos + 1)
+            < 0) {
+            return false;
+        }
+
+        out = std::move(cell.value);
+        cell.value = T {};
+        cell.sequence.store(pos + Capacity, std::memory_order_release);
+        pDequeuePos.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Consumer thread only. Pops everything queued so far into fn.
+     *
+     * @return the number of values popped
+     */
+    template <typename Fn> size_t drain(Fn&& fn)
+    {
+        size_t count = 0;
+        T value;
+        while (this->tryPop(value)) {
+            fn(value);
+            count++;
+        }
+        return count;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    // Approximate when read while producers are running
+    [[nodiscard]] size_t depth() const
+    {
+        return pEnqueuePos.load(std::memory_order_relaxed)
+            - pDequeuePos.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] size_t highWater() const
+    {
+        return pHighWater.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint64_t overflows() const
+    {
+        return pOverflows.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::array<Cell, Capacity> pCells;
+    // Producers and the consumer write these, keep them on their own lines
+    alignas(64) std::atomic<size_t> pEnqueuePos = 0;
+    alignas(64) std::atomic<size_t> pDequeuePos = 0;
+    alignas(64) std::atomic<size_t> pHighWater = 0;
+    std::atomic<uint64_t> pOverflows = 0;
+};
+
+/**
+ * An afv-native client event with its payload copied out, the pointers given
+ * to the callback are only valid while it runs.
+ */
+struct ClientEvent {
+    afv_native::ClientEventType type
+        = afv_native::ClientEventType::APIServerConnected;
+
+    // Rx and pilot rx events, station data
+    int frequencyHz = 0;
+    // Pilot rx callsign, station name, device name
+    std::string text;
+    // Voice server error codes
+    int errorCode = 0;
+    afv_native::afv::APISessionError apiError
+        = afv_native::afv::APISessionError::NoError;
+    // Station data
+    bool found = false;
+    // VCCS stations, by name
+    std::vector<std::pair<std::string, unsigned int>> stations;
+    // Set by ClientEventQueue, orders the events across its two lanes
+    uint64_t sequence = 0;
+
+    /**
+     * Copies the payload of an event as given to the client callback.
+     */
+    static ClientEvent fromCallback(
+        afv_native::ClientEventType type, void* data, void* data2);
+};
+
+/**
+ * Client events waiting for a consumer thread, pushed from the afv-native
+ * thread without ever waiting on the consumer.
+ *
+ * RX and PTT events come in bursts and only their latest state matters, so
+ * they go through a bounded MpscRing and are dropped and counted when it is
+ * full. Everything else (connection changes, errors, station data) is rare,
+ * and losing one would leave the app showing a connection that is gone or a
+ * station without transceivers, so those are never dropped and wait in an
+ * unbounded list. Both lanes are drained in the order events were pushed.
+ */
+class ClientEventQueue {
+public:
+    static constexpr size_t kHighRateCapacity = 1024;
+
+    ClientEventQueue() = default;
+
+    ClientEventQueue(const ClientEventQueue&) = delete;
+    ClientEventQueue& operator=(const ClientEventQueue&) = delete;
+
+    /**
+     * Any thread. Returns false and counts an overflow if this was an RX or
+     * PTT event and its lane is full, any other event is always queued.
+     */
+    bool push(ClientEvent event);
+
+    /**
+     * Consumer thread only. Pops everything queued so far into fn, in the
+     * order it was pushed.
+     *
+     * @return the number of events popped
+     */
+    template <typename Fn> size_t drain(Fn&& fn)
+    {
+        // Events pushed from here on are left for the next call, otherwise
+        // an RX event could be handed out before an older control event
+        uint64_t end = 0;
+        {
+            const std::lock_guard<std::mutex> l(pMutex);
+            pDraining.swap(pControl);
+            end = pNextSequence.load();
+        }
+
+        size_t count = 0;
+        auto control = pDraining.begin();
+        while (true) {
+            if (!pHighRateHead) {
+                ClientEvent event;
+                if (pHighRate.tryPop(event)) {
+                    pHighRateHead = std::move(event);
+                }
+            }
+            const bool highRateDue
+                = pHighRateHead && pHighRateHead->sequence < end;
+
+            if (control != pDraining.end()
+                && (!highRateDue
+                    || control->sequence < pHighRateHead->sequence)) {
+                fn(*control);
+                ++control;
+            } else if (highRateDue) {
+                fn(*pHighRateHead);
+                pHighRateHead.reset();
+            } else {
+                break;
+            }
+            count++;
+        }
+
+        // Keeps its capacity for the next swap
+        pDraining.clear();
+        pHoldingHead = pHighRateHead.has_value();
+        return count;
+    }
+
+    // Approximate when read while producers are running
+    [[nodiscard]] size_t depth() const;
+    [[nodiscard]] size_t highWater() const { return pHighRate.highWater(); }
+    [[nodiscard]] uint64_t overflows() const { return pHighRate.overflows(); }
+
+    /**
+     * Whether events of this type go through the bounded lane.
+     */
+    [[nodiscard]] static bool isHighRate(afv_native::ClientEventType type);
+
+private:
+    std::atomic<uint64_t> pNextSequence = 0;
+    MpscRing<ClientEvent, kHighRateCapacity> pHighRate;
+
+    mutable std::mutex pMutex;
+    std::vector<ClientEvent> pControl; // Guarded by pMutex
+
+    // Consumer thread only
+    std::vector<ClientEvent> pDraining;
+    // Popped from the ring but newer than the last drain
+    std::optional<ClientEvent> pHighRateHead;
+    std::atomic<bool> pHoldingHead = false;
+};
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "afv-native/atcClientWrapper.h"
+#include "afv-native/event.h"
+#include "afv/client_event_queue.h"
+#include "ns/station_registry.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace vector_audio::afv {
+
+/**
+ * The state of one frequency, as afv-native last reported it.
+ */
+struct RadioState {
+    bool rx = false;
+    bool tx = false;
+    bool xc = false;
+    bool onHeadset = true;
+    // Whether afv-native has the frequency at all
+    bool active = false;
+
+    bool rxActive = false;
+    bool txActive = false;
+    std::string lastReceivedCallsign;
+};
+
+/**
+ * Caches the radio state of every station so the UI and the SDK can read it
+ * as often as they like without calling into afv-native, which takes its own
+ * locks on every call.
+ *
+ * Frequencies are only queried again when something changed them: a station
+ * was added, removed or got its transceivers, or the app changed its state
+ * and invalidated it.
+ * Receiving and transmitting are followed through the afv events, whoever
+ * drops some of them must call invalidateAll(). A slow full refresh is kept
+ * as a safety net for changes afv-native makes on its own.
+ */
+class RadioStateCache {
+public:
+    static constexpr std::chrono::seconds kFullRefreshInterval { 30 };
+
+    RadioStateCache(std::shared_ptr<afv_native::api::atcClient> client,
+        ns::StationRegistry& stations);
+    ~RadioStateCache();
+
+    RadioStateCache(const RadioStateCache&) = delete;
+    RadioStateCache& operator=(const RadioStateCache&) = delete;
+
+    /**
+     * Queries afv-native for the frequencies that need it. Called once per
+     * frame from the render thread.
+     */
+    void refresh();
+
+    /**
+     * Must be called after changing the state of a frequency through the
+     * client, so that the next refresh picks it up.
+     */
+    void invalidate(int frequencyHz);
+    void invalidateAll();
+
+    void handleEvent(const ClientEvent& event);
+    void setPtt(bool open);
+
+    /**
+     * @return the cached state, all off if the frequency is unknown.
+     */
+    [[nodiscard]] RadioState get(int frequencyHz) const;
+
+    /**
+     * Incremented on every change, to tell cheaply whether anything moved.
+     */
+    [[nodiscard]] uint64_t getVersion() const { return pVersion; }
+
+private:
+    std::shared_ptr<afv_native::api::atcClient> pClient;
+    ns::StationRegistry& pStations;
+    int pStationListener = 0;
+
+    mutable std::shared_mutex pMutex;
+    std::unordered_map<int, RadioState> pStates;
+    std::unordered_set<int> pDirty;
+    bool pAllDirty = true;
+    bool pPttOpen = false;
+    std::atomic<uint64_t> pVersion = 0;
+
+    // Only touched by the render thread
+    std::chrono::steady_clock::time_point pLastFullRefresh;
+    std::vector<int> pToRefresh;
+    // Empty for the invalidated frequencies that no longer have a station
+    std::vector<std::pair<int, std::optional<RadioState>>> pRefreshed;
+
+    RadioState query(int frequencyHz) const;
+};
+}
@@ -1,33 +1,42 @@
 #pragma once
 #include "afv-native/atcClientWrapper.h"
 #include "afv-native/event.h"
+#include "afv/client_event_queue.h"
+#include "afv/radio_state_cache.h"
 #include "config.h"
 #include "data_file_handler.h"
 #include "imgui.h"
 #include "imgui_internal.h"
 #include "imgui_stdlib.h"
-#include "ns/airport.h"
+#include "native/ptt_monitor.h"
+#include "native/win32_key_util.h"
+#include "ns/airport_database.h"
 #include "radioSimulation.h"
 #include "sdk/sdk.h"
 #include "shared.h"
+#include "ui/frame_pacer.h"
 #include "ui/modals/settings.h"
 #include "ui/style.h"
 #include "ui/widgets/addstation.widget.h"
 #include "ui/widgets/gain.widget.h"
 #include "ui/widgets/lastrx.widget.h"
 #include "ui/widgets/networkstatus.widget.h"
+#include "ui/widgets/pttlatency.widget.h"
 #include "util.h"
 #include "updater.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <httplib.h>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <numeric>
+#include <optional>
 #include <SFML/Audio.hpp>
 #include <SFML/Audio/Sound.hpp>
 #include <SFML/Audio/SoundBuffer.hpp>
@@ -41,39 +50,104 @@
 namespace vector_audio::application {
 class App {
 public:
-    App();
+    explicit App(ui::FramePacer& framePacer);
     ~App();
 
     void render_frame();
 
-private:
-    static bool frequencyExists(int freq);
+    // Whether the last frame showed something that changes on its own
+    [[nodiscard]] bool wantsContinuousFrames() const
+    {
+        return pWantsContinuousFrames;
+    }
 
+private:
     void errorModal(std::string message);
 
     std::shared_ptr<afv_native::api::atcClient> pClient;
+    std::shared_ptr<afv::RadioStateCache> pRadioState;
 
+    // Runs on the afv-native thread, only queues the event
     void eventCallback(
         afv_native::ClientEventType evt, void* data, void* data2);
 
+    // Handles the events queued since the last frame, on the render thread
+    void drainClientEvents();
+    void handleClientEvent(const afv::ClientEvent& event);
+
+    afv::ClientEventQueue pClientEvents;
+    uint64_t pReportedEventOverflows = 0;
+
     void disconnectAndCleanup();
 
     void playErrorSound();
 
+    // Runs on the PTT thread
+    void handlePttChange(bool pressed);
+
+    // The input to watch, nothing unless voice is connected
+    [[nodiscard]] native::PttBinding currentPttBinding() const;
+
     void addNewStation(std::string callsign);
 
-    // Used in another thread
-    static void loadAirportsDatabaseAsync();
+    // Applies the result of the background pilot lookup once it is ready
+    void handlePilotLookupResult();
+
+    void cancelPilotLookup();
+
+    enum class ConnectStage {
+        kIdle,
+        kCheckingSession,
+        kSettingUpAudio,
+        kResolvingPosition,
+        kConnecting,
+    };
+
+    // Starts the connect sequence on a background thread
+    void startConnect();
+
+    // Runs every stage of the connect sequence, returns an error message if
+    // one of them fails
+    std::optional<std::string> runConnectSequence();
+
+    // Sets the transceiver position from the best source available
+    void resolveClientPosition();
+
+    void handleConnectResult();
+
+    static const char* connectStageLabel(ConnectStage stage);
 
     bool pShowErrorModal = false;
     std::string pLastErrorModalMessage;
 
     std::unique_ptr<vatsim::DataHandler> pDataHandler;
 
+    // Declared before the connect sequence, which looks airports up from its
+    // own thread
+    ns::AirportDatabase pAirportDatabase;
+
+    // Declared after pDataHandler so that any lookup still running is waited
+    // for before the handler it uses is destroyed
+    using PilotPosition = std::optional<std::pair<double, double>>;
+    struct PilotLookup {
+        std::string callsign;
+        std::future<PilotPosition> result;
+    };
+    std::optional<PilotLookup> pPilotLookup;
+    std::vector<std::future<PilotPosition>> pCancelledPilotLookups;
+
+    std::atomic<ConnectStage> pConnectStage = ConnectStage::kIdle;
+    std::future<std::optional<std::string>> pConnectResult;
+
     bool pManuallyDisconnected = false;
     sf::SoundBuffer pDisconnectWarningSoundbuffer;
     sf::Sound pSoundPlayer;
 
     std::unique_ptr<SDK> pSDK;
+    std::unique_ptr<native::PttMonitor> pPttMonitor;
+
+    ui::FramePacer& pFramePacer;
+    int pStationListener = 0;
+    bool pWantsContinuousFrames = false;
 };
 }
\ No newline at end of file
@@ -22,6 +22,7 @@ public:
 
     static inline std::string mConfigFileName = "config.toml";
     static inline std::string mAirportsDBFilePath = "airports.json";
+    static inline std::string mAirportsIndexFilePath = "airports.bin";
 
     static void build_config();
 
@@ -1,6 +1,14 @@
 #pragma once
+#include "net/http_client_pool.h"
+#include "net/http_fetcher.h"
 #include "shared.h"
 #include "util.h"
+#include "vatsim/datafile_parser.h"
+#include "vatsim/datafile_snapshot.h"
+#include "vatsim/endpoints.h"
+#include "vatsim/mirror_tracker.h"
+#include "vatsim/poll_scheduler.h"
+#include "vatsim/slurper_parser.h"
 
 #include <absl/strings/match.h>
 #include <absl/strings/str_split.h>
@@ -13,10 +21,12 @@
 #include <mutex>
 #include <nlohmann/json.hpp>
 #include <nlohmann/json_fwd.hpp>
+#include <optional>
 #include <random>
 #include <regex>
 #include <spdlog/spdlog.h>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -26,7 +36,7 @@ using namespace std::chrono_literals;
 
 class DataHandler {
 public:
-    DataHandler();
+    explicit DataHandler(Endpoints endpoints = {});
     virtual ~DataHandler()
     {
         {
@@ -37,6 +47,20 @@ public:
 
         if (pWorkerThread->joinable())
             pWorkerThread->join();
+
+        for (const auto& [host, stats] :
+            net::HttpClientPool::instance().getStats()) {
+            spdlog::info("{}: {} requests, {} handshakes saved, average "
+                         "latency {}us",
+                host, stats.requests, stats.handshakesSaved,
+                stats.averageLatency().count());
+        }
+
+        auto fetchStats = net::HttpFetcher::instance().getStats();
+        spdlog::info("VATSIM data: {} requests, {} not modified, {} bytes "
+                     "received, {} bytes saved",
+            fetchStats.requests, fetchStats.notModified,
+            fetchStats.bytesReceived, fetchStats.bytesSaved);
     };
 
     bool isSlurperAvailable() const { return this->pSlurperAvailable; }
@@ -50,24 +74,76 @@ public:
     bool getPilotPositionWithAnything(
         const std::string& callsign, double& latitude, double& longitude);
 
+    /**
+     * Returns the latest datafile snapshot, only going to the network if the
+     * published one has gone stale or does not cover what is asked for.
+     *
+     * @param withPilots Whether the pilots must be indexed, the session
+     * watcher alone leaves them out.
+     * @return nullptr if no fresh snapshot could be fetched.
+     */
+    std::shared_ptr<const DatafileSnapshot> getDatafileSnapshot(
+        bool withPilots);
+
+    // Polls VATSIM right away instead of waiting for the next scheduled poll
+    void wake();
+
+    // Polls often for a little while, used when the user asks to connect
+    void requestFastPolling();
+
+    // Only called from the render thread
+    void setWindowFocused(bool focused);
+
+    PollScheduler::Clock::duration getPollInterval() const
+    {
+        return pScheduler.getInterval();
+    }
+
+    PollScheduler::Clock::time_point getNextPollAt() const
+    {
+        return pScheduler.getNextPollAt();
+    }
+
+    std::vector<MirrorTracker::Health> getMirrorHealth() const
+    {
+        return pMirrors.getHealth();
+    }
+
+    // Latency of the last slurper request, if there was one
+    std::optional<std::chrono::milliseconds> getSlurperLatency() const;
+
 private:
+    const Endpoints pEndpoints;
     std::regex pRegexp;
     std::unique_ptr<std::thread> pWorkerThread;
     std::atomic<bool> pKeepRunning = true;
     std::condition_variable pCv;
     std::mutex pDfMutex;
+    bool pWakeRequested = false; // Guarded by pDfMutex
+
+    PollScheduler pScheduler;
+    bool pWindowFocused = true;
+
+    MirrorTracker pMirrors;
+
+    // The datafile is refreshed by VATSIM every 15 seconds
+    static constexpr auto kDatafileSnapshotTtl = 15s;
 
-    std::string pDatafileHost;
-    std::string pDatafileUrl;
+    // Only ever accessed through std::atomic_load and std::atomic_store
+    std::shared_ptr<const DatafileSnapshot> pDatafileSnapshot;
+    // Serialises refreshes so concurrent lookups share a single download
+    std::mutex pSnapshotFetchMutex;
+    Mirror pSnapshotMirror; // Guarded by pSnapshotFetchMutex
 
-    bool pSlurperAvailable = false;
-    bool pDataFileAvailable = false;
+    // Read from the render thread and from pilot lookups
+    std::atomic<bool> pSlurperAvailable = false;
+    std::atomic<bool> pDataFileAvailable = false;
     bool pHadOneDisconnect = false;
-    bool pYx = false;
 
-    static std::string downloadString(httplib::Client& cli, std::string url);
+    static std::string downloadString(
+        const std::string& host, const std::string& url);
 
-    bool parseSlurper(const std::string& sluper_data);
+    bool parseSlurper(std::string_view sluper_data);
 
     bool getLatestDatafileURL();
 
@@ -79,7 +155,7 @@ private:
 
     bool checkIfdatafileAvailable();
 
-    static bool checkIfSlurperAvailable();
+    bool checkIfSlurperAvailable() const;
 
     void getAvailableEndpoints();
 
@@ -87,12 +163,32 @@ private:
 
     void handleDisconnect();
 
-    static bool parseDatafile(const std::string& data);
+    /**
+     * Streams the datafile from the given mirror into the parser, stopping
+     * the download early if the parser does not need any more data.
+     *
+     * @param conditional Whether the server may answer with a 304, in which
+     * case the parser is never fed.
+     */
+    net::FetchStatus streamDatafile(DatafileStreamParser& parser,
+        const Mirror& mirror, bool conditional);
+
+    /**
+     * Downloads a new snapshot and publishes it, called with
+     * pSnapshotFetchMutex held. Without pilots, the download stops as soon as
+     * our own controller entry has been read.
+     *
+     * @return nullptr if no mirror could provide the datafile.
+     */
+    std::shared_ptr<const DatafileSnapshot> refreshDatafileSnapshot(
+        bool withPilots);
+
+    static bool parseDatafileController(const DatafileRecord& controller);
 
     static void updateSessionInfo(std::string callsign, int frequency = 0,
         int facility = 0, double latitude = 0.0, double longitude = 0.0);
 
-    static void handleConnect();
+    void handleConnect();
 
     void worker();
 };
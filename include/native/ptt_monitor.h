@@ -0,0 +1,201 @@
+#pragma once
+#include <SFML/Window/Keyboard.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace vector_audio::native {
+
+/**
+ * The input the push to talk is bound to.
+ */
+struct PttBinding {
+    sf::Keyboard::Scancode key = sf::Keyboard::Scan::Unknown;
+    sf::Keyboard::Key fallbackKey = sf::Keyboard::Unknown;
+    int joystickId = -1;
+    int joystickButton = -1;
+    // Used to find the joystick device when reading events directly
+    std::string joystickName;
+    // Windows virtual key of the key, resolved on the main thread since it
+    // depends on the keyboard layout. 0 when unknown or on other platforms
+    int virtualKey = 0;
+
+    [[nodiscard]] bool isSet() const
+    {
+        return key != sf::Keyboard::Scan::Unknown || joystickId != -1;
+    }
+
+    bool operator==(const PttBinding& other) const
+    {
+        return key == other.key && fallbackKey == other.fallbackKey
+            && joystickId == other.joystickId
+            && joystickButton == other.joystickButton
+            && joystickName == other.joystickName
+            && virtualKey == other.virtualKey;
+    }
+    bool operator!=(const PttBinding& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+/**
+ * Counts latencies into fixed buckets, safe to record into and read from
+ * different threads.
+ */
+class LatencyHistogram {
+public:
+    // Upper bound of each bucket in microseconds, the last one has none
+    static constexpr std::array<int64_t, 8> kBucketLimitsUs
+        = { 500, 1000, 2000, 5000, 10000, 20000, 50000, 0 };
+    static constexpr const char* kBucketLabels[]
+        = { "<0.5", "<1", "<2", "<5", "<10", "<20", "<50", ">50" };
+
+    void record(std::chrono::steady_clock::duration latency);
+
+    [[nodiscard]] std::array<uint64_t, kBucketLimitsUs.size()> counts() const;
+
+    /**
+     * @return the upper bound of the bucket holding the given percentile, in
+     * milliseconds, or a negative value if nothing was recorded or the value
+     * is above the last bound
+     */
+    [[nodiscard]] float percentileMs(float percentile) const;
+
+    [[nodiscard]] uint64_t total() const;
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketLimitsUs.size()> pCounts {};
+};
+
+/**
+ * Reads one input source for the monitor thread.
+ */
+class PttBackend {
+public:
+    virtual ~PttBackend() = default;
+
+    /**
+     * Waits up to timeout for the input to change.
+     *
+     * @param pressed holds the last known state of the input, set to the
+     * current one
+     * @param seenAt set to when the input was observed, as close to the
+     * hardware as the backend can tell
+     * @return false if the backend failed and should be replaced
+     */
+    virtual bool wait(std::chrono::milliseconds timeout, bool& pressed,
+        std::chrono::steady_clock::time_point& seenAt)
+        = 0;
+
+    [[nodiscard]] virtual const char* name() const = 0;
+};
+
+/**
+ * Reads the kernel input devices on Linux, nullptr if the binding cannot be
+ * read that way (unknown key, no read access to /dev/input) or on any other
+ * platform.
+ */
+std::unique_ptr<PttBackend> makeEvdevPttBackend(const PttBinding& binding);
+
+/**
+ * The input state last sampled by the main thread, for the bindings that can
+ * only be read through SFML.
+ */
+struct ForwardedPttSample {
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool pressed = false;
+    // The frame before the one that saw the change, the input may have
+    // changed right after it was read there
+    std::chrono::steady_clock::time_point seenAt;
+    // When the main thread last read the input
+    std::chrono::steady_clock::time_point sampledAt;
+};
+
+/**
+ * Watches the push to talk input from its own thread so that presses are
+ * forwarded without waiting for the next UI frame.
+ *
+ * Linux reads input events straight from the kernel when it is allowed to,
+ * Windows polls keyboard keys with GetAsyncKeyState every kPollInterval.
+ * SFML's input state is only safe to read from the thread polling the
+ * window, so any other binding is sampled there with sampleWithSfml() and
+ * handed over with reportSample().
+ */
+class PttMonitor {
+public:
+    static constexpr std::chrono::milliseconds kPollInterval { 1 };
+    // How quickly binding changes and shutdown are noticed
+    static constexpr std::chrono::milliseconds kWaitTimeout { 100 };
+
+    /**
+     * Called from the monitor thread whenever the input changes. The time it
+     * takes is recorded as the press latency.
+     */
+    using Callback = std::function<void(bool pressed)>;
+
+    explicit PttMonitor(Callback onChange);
+    ~PttMonitor();
+
+    PttMonitor(const PttMonitor&) = delete;
+    PttMonitor& operator=(const PttMonitor&) = delete;
+
+    /**
+     * Replaces the input being watched. Thread safe, cheap when unchanged.
+     */
+    void setBinding(const PttBinding& binding);
+
+    [[nodiscard]] const LatencyHistogram& getLatency() const
+    {
+        return pLatency;
+    }
+
+    /**
+     * Name of the backend currently reading the input, for display.
+     */
+    [[nodiscard]] std::string getBackendName() const;
+
+    /**
+     * Whether the current binding must be sampled by the main thread and
+     * handed over with reportSample(), the input is then only as recent as
+     * the last frame.
+     */
+    [[nodiscard]] bool sampledOnMainThread() const;
+
+    /**
+     * Main thread only. Reads the binding through SFML.
+     */
+    [[nodiscard]] static bool sampleWithSfml(const PttBinding& binding);
+
+    /**
+     * Hands over the state read with sampleWithSfml(). Cheap when unchanged.
+     */
+    void reportSample(bool pressed);
+
+private:
+    void run();
+
+    Callback pOnChange;
+    LatencyHistogram pLatency;
+    ForwardedPttSample pSample;
+
+    mutable std::mutex pMutex;
+    std::condition_variable pBindingChanged;
+    PttBinding pBinding;
+    uint64_t pBindingVersion = 0;
+    std::string pBackendName = "none";
+    bool pStop = false;
+    std::atomic<bool> pSampledOnMainThread = false;
+
+    std::thread pThread;
+};
+}
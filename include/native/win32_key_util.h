@@ -6,4 +6,13 @@
 
 namespace vector_audio::native::win32 {
     std::string get_key_description(sf::Keyboard::Scancode code);
-}
\ No newline at end of file
+
+#ifdef _WIN32
+    /**
+     * The virtual key code GetAsyncKeyState takes for a key under the current
+     * layout, 0 if there is none. Calls into SFML, main thread only.
+     */
+    int get_virtual_key(
+        sf::Keyboard::Scancode code, sf::Keyboard::Key fallbackKey);
+#endif
+}
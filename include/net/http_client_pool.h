@@ -0,0 +1,93 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <httplib.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vector_audio::net {
+using namespace std::chrono_literals;
+
+/**
+ * Per-host pool of keep-alive HTTP clients.
+ *
+ * Creating an httplib::Client for each request means a new TCP and TLS
+ * handshake every time. Clients are instead handed out from, and returned to,
+ * this pool so that the connection stays open between requests. A client
+ * that has been idle for longer than kIdleTimeout is dropped, as the server
+ * will most likely have closed its end by then.
+ */
+class HttpClientPool {
+public:
+    struct HostStats {
+        uint64_t requests = 0;
+        uint64_t handshakesSaved = 0;
+        std::chrono::microseconds lastLatency { 0 };
+        std::chrono::microseconds totalLatency { 0 };
+        std::chrono::microseconds maxLatency { 0 };
+
+        [[nodiscard]] std::chrono::microseconds averageLatency() const
+        {
+            return requests == 0
+                ? std::chrono::microseconds(0)
+                : totalLatency / static_cast<int64_t>(requests);
+        }
+    };
+
+    static HttpClientPool& instance();
+
+    /**
+     * Runs a request on a pooled client for the given host, timing it.
+     *
+     * @param host The scheme and host, e.g. https://status.vatsim.net
+     * @param request Callable taking an httplib::Client& and returning the
+     * result of the request.
+     */
+    template <typename Fn> auto with(const std::string& host, Fn&& request)
+    {
+        bool reused = false;
+        auto client = this->acquire(host, reused);
+        // httplib closes the socket after a failed or cancelled request, a
+        // pooled client then has to connect again
+        reused = reused && client->is_socket_open();
+
+        auto t1 = std::chrono::steady_clock::now();
+        auto res = request(*client);
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - t1);
+
+        this->release(host, std::move(client), reused, latency);
+        return res;
+    }
+
+    httplib::Result get(const std::string& host, const std::string& path,
+        const httplib::Headers& headers = {});
+
+    [[nodiscard]] std::map<std::string, HostStats> getStats();
+
+private:
+    HttpClientPool() = default;
+
+    static constexpr auto kIdleTimeout = 30s;
+    static constexpr size_t kMaxIdlePerHost = 4;
+
+    struct IdleClient {
+        std::unique_ptr<httplib::Client> client;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+
+    std::mutex pMutex;
+    std::map<std::string, std::vector<IdleClient>> pIdle;
+    std::map<std::string, HostStats> pStats;
+
+    std::unique_ptr<httplib::Client> acquire(
+        const std::string& host, bool& reused);
+    void release(const std::string& host,
+        std::unique_ptr<httplib::Client> client, bool reused,
+        std::chrono::microseconds latency);
+};
+}
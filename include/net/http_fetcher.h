@@ -0,0 +1,72 @@
+#pragma once
+#include "net/http_client_pool.h"
+
+#include <cstdint>
+#include <httplib.h>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace vector_audio::net {
+
+enum class FetchStatus {
+    kOk,
+    kNotModified,
+    kError,
+};
+
+/**
+ * Thin GET layer on top of the HttpClientPool.
+ *
+ * Requests advertise gzip support, which httplib decompresses on the fly
+ * before handing data to the caller, and are made conditional with the ETag
+ * and Last-Modified validators of the previous response to the same URL, so
+ * an unchanged document costs a 304 and no body at all.
+ */
+class HttpFetcher {
+public:
+    struct Stats {
+        uint64_t requests = 0;
+        uint64_t notModified = 0;
+        uint64_t bytesReceived = 0; // On the wire, when the server told us
+        uint64_t bytesDecoded = 0;
+        uint64_t bytesSaved = 0; // Through 304s and compression
+    };
+
+    static HttpFetcher& instance();
+
+    /**
+     * Downloads a whole document. A 304 is transparently answered from the
+     * copy kept from the last successful download.
+     */
+    FetchStatus fetch(
+        const std::string& host, const std::string& path, std::string& body);
+
+    /**
+     * Streams a document to the receiver as it is downloaded and decoded.
+     *
+     * @param conditional Whether to send the stored validators, only set this
+     * if the caller still has the data of the previous download, since the
+     * receiver is not called at all on a 304.
+     */
+    FetchStatus stream(const std::string& host, const std::string& path,
+        const httplib::ContentReceiver& receiver, bool conditional);
+
+    [[nodiscard]] Stats getStats();
+
+private:
+    HttpFetcher() = default;
+
+    struct CacheEntry {
+        std::string etag;
+        std::string lastModified;
+        uint64_t size = 0;
+        std::optional<std::string> body;
+    };
+
+    std::mutex pMutex;
+    std::map<std::string, CacheEntry> pCache;
+    Stats pStats;
+};
+}
@@ -1,6 +1,9 @@
+#pragma once
+#include <istream>
 #include <map>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <utility>
 
 namespace ns {
 
@@ -9,11 +12,35 @@ public:
     // Although we have more data available, we don't actually need it, so
     // ignoring for now
     std::string icao;
+    // Empty if the airport has none
+    std::string iata;
     int elevation;
     double lat;
     double lon;
 
-    // Store all the loaded airports
-    static inline std::map<std::string, Airport> mAll;
+    // Parses the airports.json database from a stream or a string, throws
+    // nlohmann::json::exception if it is malformed
+    template <typename Input>
+    static std::map<std::string, Airport> parseDatabase(Input&& in)
+    {
+        std::map<std::string, Airport> airports;
+        nlohmann::json data = nlohmann::json::parse(std::forward<Input>(in));
+
+        // Loop through all the icaos
+        for (const auto& obj : data.items()) {
+            Airport ar;
+            obj.value().at("icao").get_to(ar.icao);
+            if (obj.value().contains("iata")
+                && obj.value()["iata"].is_string()) {
+                obj.value()["iata"].get_to(ar.iata);
+            }
+            obj.value().at("elevation").get_to(ar.elevation);
+            obj.value().at("lat").get_to(ar.lat);
+            obj.value().at("lon").get_to(ar.lon);
+            airports.insert(std::make_pair(obj.key(), ar));
+        }
+
+        return airports;
+    }
 };
 }
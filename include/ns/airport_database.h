@@ -0,0 +1,112 @@
+#pragma once
+#include "ns/airport.h"
+#include "ns/airport_grid.h"
+#include "ns/airport_index.h"
+#include "ns/callsign_resolver.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ns {
+
+/**
+ * Owns the airport database. It is loaded on a worker thread and only
+ * published once complete, so lookups either see the whole database or
+ * nothing at all.
+ */
+class AirportDatabase {
+public:
+    // How long a lookup made before loading is over waits for it
+    static constexpr std::chrono::seconds kLookupTimeout { 5 };
+
+    struct Tables {
+        // Open when the database was loaded from the binary index
+        AirportIndex index;
+        // Filled when it was loaded from the json instead
+        std::map<std::string, Airport> all;
+        AirportGrid grid;
+        CallsignResolver resolver;
+
+        [[nodiscard]] std::optional<Airport> find(std::string_view icao) const;
+    };
+
+    AirportDatabase() = default;
+    // Waits for loading to finish
+    ~AirportDatabase();
+
+    AirportDatabase(const AirportDatabase&) = delete;
+    AirportDatabase& operator=(const AirportDatabase&) = delete;
+
+    /**
+     * Starts loading the database, from the index if it can be mapped and
+     * from the json otherwise. Must only be called once.
+     *
+     * @param onLoaded Called from the loading thread once loading is over,
+     * whether it worked or not.
+     */
+    void loadAsync(std::string indexPath, std::string jsonPath,
+        std::map<std::string, CallsignResolver::Alias> aliases = {},
+        std::function<void()> onLoaded = {});
+
+    /**
+     * Becomes ready once loading is over, holds whether it succeeded.
+     */
+    [[nodiscard]] std::shared_future<bool> ready() const { return pReady; }
+
+    /**
+     * The published tables, nullptr while loading or if loading failed.
+     */
+    [[nodiscard]] std::shared_ptr<const Tables> get() const;
+
+    /**
+     * Loading progress, between 0 and 1.
+     */
+    [[nodiscard]] float getProgress() const { return pProgress; }
+    [[nodiscard]] bool isLoading() const;
+
+    /**
+     * Looks an airport up by ICAO code. Before the database is published,
+     * this maps the index for the one lookup, or waits for loading to finish
+     * if there is no index.
+     */
+    [[nodiscard]] std::optional<Airport> find(std::string_view icao) const;
+
+    /**
+     * Resolves a callsign to its airport or sector reference point, see
+     * CallsignResolver. Before the database is published, only the ICAO
+     * prefix is looked up.
+     */
+    [[nodiscard]] std::optional<Airport> resolveCallsign(
+        std::string_view callsign) const;
+
+    /**
+     * Finds the closest airport to a position, waiting for loading to finish
+     * if needed.
+     */
+    [[nodiscard]] std::optional<Airport> nearest(
+        double lat, double lon, double maxDistanceKm) const;
+
+private:
+    std::string pIndexPath;
+    std::string pJsonPath;
+    std::map<std::string, CallsignResolver::Alias> pAliases;
+
+    std::shared_future<bool> pReady;
+    std::shared_ptr<const Tables> pTables;
+    std::atomic<float> pProgress = 0.0F;
+
+    bool load();
+    bool loadIndex(Tables& tables, std::vector<Airport>& airports);
+    bool loadJson(Tables& tables, std::vector<Airport>& airports);
+
+    [[nodiscard]] std::shared_ptr<const Tables> waitForTables() const;
+};
+}
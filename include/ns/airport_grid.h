@@ -0,0 +1,53 @@
+#pragma once
+#include "ns/airport.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace ns {
+
+/**
+ * Buckets the airports into one degree cells so the nearest airport to any
+ * position can be found by only looking at the few cells around it.
+ *
+ * Cells are stored contiguously, with an offset table pointing at the start of
+ * each one, which keeps a full database to a couple of megabytes.
+ */
+class AirportGrid {
+public:
+    static constexpr int kLatCells = 180;
+    static constexpr int kLonCells = 360;
+
+    /**
+     * Replaces the grid contents with the given airports.
+     */
+    void build(std::vector<Airport> airports);
+
+    [[nodiscard]] bool empty() const { return pAirports.empty(); }
+    [[nodiscard]] size_t size() const { return pAirports.size(); }
+
+    /**
+     * Finds the airport closest to the given position.
+     *
+     * @param maxDistanceKm airports further than this are ignored
+     * @return the airport, or nullopt if there is none in range
+     */
+    [[nodiscard]] std::optional<Airport> nearest(
+        double lat, double lon, double maxDistanceKm) const;
+
+    /**
+     * Great circle distance between two positions, in kilometers.
+     */
+    static double distanceKm(
+        double lat1, double lon1, double lat2, double lon2);
+
+private:
+    std::vector<Airport> pAirports;
+    // pAirports[pCellStart[c] .. pCellStart[c + 1]) are the airports of cell c
+    std::vector<uint32_t> pCellStart;
+
+    static int latCell(double lat);
+    static int lonCell(double lon);
+};
+}
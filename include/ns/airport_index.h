@@ -0,0 +1,89 @@
+#pragma once
+#include "ns/airport.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace ns {
+
+/**
+ * Read-only view of the binary airport index compiled from airports.json at
+ * build time.
+ *
+ * The file is a small header followed by fixed-width records sorted by ICAO
+ * code. It is memory mapped rather than read, so opening it costs no parsing
+ * at all and the pages are shared between every running instance.
+ */
+class AirportIndex {
+public:
+    static constexpr char kMagic[4] = { 'V', 'A', 'A', 'I' };
+    static constexpr uint32_t kVersion = 2;
+    static constexpr size_t kKeySize = 8;
+    static constexpr size_t kIataSize = 4;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        // Always 1 when written, reads differently on a machine of the other
+        // endianness
+        uint32_t byteOrder;
+        uint32_t count;
+    };
+
+    struct Record {
+        char icao[kKeySize]; // Zero padded
+        char iata[kIataSize]; // Zero padded, empty if there is none
+        int32_t latitudeE6;
+        int32_t longitudeE6;
+        int32_t elevation;
+    };
+
+    AirportIndex() = default;
+    ~AirportIndex();
+
+    AirportIndex(const AirportIndex&) = delete;
+    AirportIndex& operator=(const AirportIndex&) = delete;
+
+    /**
+     * Maps the index file, replacing any index that was already open.
+     *
+     * @return false if the file is missing, truncated or not an index of this
+     * version.
+     */
+    bool open(const std::string& path);
+    void close();
+
+    [[nodiscard]] bool isOpen() const { return pRecords != nullptr; }
+    [[nodiscard]] size_t size() const { return pCount; }
+
+    [[nodiscard]] std::optional<Airport> find(std::string_view icao) const;
+    [[nodiscard]] Airport at(size_t i) const { return toAirport(pRecords[i]); }
+
+    /**
+     * Compiles the given airports into an index file, skipping the ones whose
+     * code does not fit in a key.
+     *
+     * @return the number of airports written, or -1 if the file could not be
+     * written.
+     */
+    static int write(const std::string& path,
+        const std::map<std::string, Airport>& airports);
+
+private:
+    const void* pMapping = nullptr;
+    size_t pMappingSize = 0;
+#ifdef _WIN32
+    void* pFileHandle = nullptr;
+    void* pMappingHandle = nullptr;
+#endif
+
+    const Record* pRecords = nullptr;
+    size_t pCount = 0;
+
+    static Airport toAirport(const Record& record);
+};
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "ns/airport.h"
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <toml.hpp>
+#include <vector>
+
+namespace ns {
+
+/**
+ * Resolves a callsign to the airport, or sector reference point, it is
+ * positioned at.
+ *
+ * Every ICAO and IATA code, as well as the user supplied aliases, is stored
+ * in a prefix trie. A callsign is walked through it once and the longest key
+ * ending on a '_' boundary wins, so that EGLL_N_APP resolves to EGLL, JFK_TWR
+ * to KJFK and an alias for LON_S to LON_S_CTR.
+ */
+class CallsignResolver {
+public:
+    /**
+     * An alias points either at an airport, or at its own reference point.
+     */
+    struct Alias {
+        std::string airport;
+        std::optional<Airport> point;
+    };
+
+    /**
+     * Reads the [airport_aliases] section of the config file:
+     *
+     *   [airport_aliases]
+     *   LON = "EGLL"
+     *   LON_S = { lat = 51.15, lon = -0.18, elevation = 200 }
+     */
+    static std::map<std::string, Alias> aliasesFromConfig(
+        const toml::value& config);
+
+    /**
+     * Replaces the trie contents. Aliases take precedence over ICAO codes,
+     * which take precedence over IATA codes.
+     */
+    void build(const std::vector<Airport>& airports,
+        const std::map<std::string, Alias>& aliases);
+
+    /**
+     * @return the best match, or nullptr if no prefix of the callsign is
+     * known. Valid as long as the resolver is.
+     */
+    [[nodiscard]] const Airport* resolve(std::string_view callsign) const;
+
+    [[nodiscard]] size_t size() const { return pTargets.size(); }
+
+private:
+    // Children are kept as a linked list, callsigns only use a few dozen
+    // characters and most nodes have a single child
+    struct Node {
+        int32_t firstChild = -1;
+        int32_t nextSibling = -1;
+        int32_t target = -1;
+        char c = 0;
+    };
+
+    std::vector<Node> pNodes;
+    std::vector<Airport> pTargets;
+
+    void insert(std::string_view key, int32_t target);
+    [[nodiscard]] int32_t child(int32_t node, char c) const;
+};
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "ns/station.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ns {
+
+/**
+ * The stations the user has added, indexed by frequency and by callsign.
+ *
+ * Stations are iterated in the order they were added. Every station gets a
+ * handle that stays valid until it is removed, regardless of what happens to
+ * the others. Readers share a lock, and listeners are told about every change
+ * once the lock has been released, so they are free to read the registry.
+ */
+class StationRegistry {
+public:
+    using Handle = uint32_t;
+
+    enum class Change {
+        kAdded,
+        kUpdated,
+        kRemoved,
+    };
+
+    using Listener = std::function<void(Change, const Station&)>;
+
+    /**
+     * Adds the station unless its frequency is already in use.
+     *
+     * @return the handle of the new station, or nullopt if the frequency is
+     * taken.
+     */
+    std::optional<Handle> add(Station station);
+
+    bool remove(Handle handle);
+    bool removeByFrequency(int frequencyHz);
+
+    /**
+     * Removes every station.
+     *
+     * @return the stations that were removed.
+     */
+    std::vector<Station> clear();
+
+    /**
+     * Updates the transceiver count of every station with this callsign.
+     */
+    void setTransceiverCount(const std::string& callsign, int count);
+
+    [[nodiscard]] bool hasFrequency(int frequencyHz) const;
+    [[nodiscard]] std::optional<Station> findByFrequency(
+        int frequencyHz) const;
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Calls fn(handle, station) for every station, in the order they were
+     * added, under the read lock. fn must not modify the registry.
+     */
+    template <typename Fn> void forEach(Fn&& fn) const
+    {
+        const std::shared_lock<std::shared_mutex> lock(pMutex);
+        for (const auto& [handle, station] : pStations) {
+            fn(handle, station);
+        }
+    }
+
+    /**
+     * @return an id to unsubscribe with.
+     */
+    int subscribe(Listener listener);
+    void unsubscribe(int id);
+
+private:
+    mutable std::shared_mutex pMutex;
+    Handle pNextHandle = 1;
+    // Handles only grow, so this is also the insertion order
+    std::map<Handle, Station> pStations;
+    std::unordered_map<int, Handle> pByFrequency;
+    std::unordered_multimap<std::string, Handle> pByCallsign;
+
+    std::mutex pListenersMutex;
+    int pNextListenerId = 1;
+    std::map<int, Listener> pListeners;
+
+    void eraseLocked(std::map<Handle, Station>::iterator it);
+    void notify(Change change, const Station& station);
+};
+}
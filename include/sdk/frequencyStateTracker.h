@@ -0,0 +1,55 @@
+#pragma once
+#include "afv/radio_state_cache.h"
+#include "ns/station.h"
+#include "ns/station_registry.h"
+
+#include <cstdint>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <optional>
+
+namespace vector_audio::sdk {
+
+/**
+ * Remembers the frequency state last sent to the websocket clients, so that
+ * only what changed since is sent next.
+ *
+ * Every change advances a sequence number carried by each message. A client
+ * that sees a gap asks for a full resync, which is the last broadcast state
+ * with its sequence number. Not thread safe.
+ */
+class FrequencyStateTracker {
+public:
+    // Stations by frequency, for each of the rx, tx and xc bars
+    struct State {
+        std::map<int, ns::Station> rx;
+        std::map<int, ns::Station> tx;
+        std::map<int, ns::Station> xc;
+    };
+
+    /**
+     * Reads the current state, must not be called while holding the station
+     * registry lock.
+     */
+    static State capture(const ns::StationRegistry& stations,
+        const afv::RadioStateCache& radioState);
+
+    /**
+     * Makes the given state the last broadcast one.
+     *
+     * @return the message describing the changes, nullopt if nothing changed
+     */
+    std::optional<nlohmann::json> update(State current);
+
+    /**
+     * The full last broadcast state, for new clients and resyncs.
+     */
+    [[nodiscard]] nlohmann::json fullMessage() const;
+
+    [[nodiscard]] uint64_t getSequence() const { return pSequence; }
+
+private:
+    State pLast;
+    uint64_t pSequence = 0;
+};
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace vector_audio::sdk {
+
+// The state versions a body was built from
+using CacheKey = std::array<uint64_t, 3>;
+
+/**
+ * A response body with its entity tag, never modified once built.
+ */
+struct CachedBody {
+    CacheKey key {};
+    std::string body;
+    // Derived from the content, so it stays valid across restarts
+    std::string etag;
+
+    static std::shared_ptr<const CachedBody> make(
+        const CacheKey& key, std::string body);
+};
+
+/**
+ * The last body built for one endpoint. Readers take a reference without
+ * locking, the body is only rebuilt when the key it was built from changes.
+ */
+class CachedResponse {
+public:
+    /**
+     * @return the body for the given key, built with build() if the cached
+     * one is for another key
+     */
+    template <typename Build>
+    std::shared_ptr<const CachedBody> get(const CacheKey& key, Build&& build)
+    {
+        auto current = std::atomic_load(&pBody);
+        if (current && current->key == key) {
+            return current;
+        }
+
+        std::shared_ptr<const CachedBody> next
+            = CachedBody::make(key, std::forward<Build>(build)());
+        std::atomic_store(&pBody, next);
+        return next;
+    }
+
+    [[nodiscard]] std::shared_ptr<const CachedBody> get() const
+    {
+        return std::atomic_load(&pBody);
+    }
+
+    /**
+     * Replaces the body, for endpoints whose content is pushed rather than
+     * pulled.
+     */
+    void publish(const CacheKey& key, std::string body)
+    {
+        std::atomic_store(&pBody, CachedBody::make(key, std::move(body)));
+    }
+
+private:
+    // Only accessed through std::atomic_load and std::atomic_store
+    std::shared_ptr<const CachedBody> pBody
+        = CachedBody::make(CacheKey {}, std::string());
+};
+
+/**
+ * Whether an If-None-Match header value lists the given entity tag.
+ */
+bool etagMatches(std::string_view ifNoneMatch, std::string_view etag);
+}
@@ -3,12 +3,19 @@
 #include "absl/strings/str_join.h"
 #include "afv-native/atcClientWrapper.h"
 #include "afv-native/event.h"
+#include "afv/client_event_queue.h"
+#include "afv/radio_state_cache.h"
 #include "ns/station.h"
+#include "sdk/frequencyStateTracker.h"
+#include "sdk/responseCache.h"
+#include "sdk/websocketRegistry.h"
 #include "sdkWebsocketMessage.h"
 #include "shared.h"
 #include "util.h"
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -23,6 +30,7 @@
 #include <restinio/websocket/websocket.hpp>
 #include <spdlog/spdlog.h>
 #include <string>
+#include <thread>
 #include <utility>
 
 namespace vector_audio {
@@ -41,13 +49,16 @@ namespace sdk::types {
 class SDK {
 
 public:
-    explicit SDK(const std::shared_ptr<afv_native::api::atcClient>& clientPtr);
+    SDK(const std::shared_ptr<afv_native::api::atcClient>& clientPtr,
+        std::shared_ptr<afv::RadioStateCache> radioState);
     ~SDK();
 
     bool start();
 
     /**
-     * Handles an AFV event for the websocket.
+     * Handles an AFV event for the websocket. Frequency state updates are
+     * coalesced for kFrequencyStateCoalesceWindow and only the changes are
+     * sent.
      *
      * @param event The AFV event to handle.
      * @param data Optional data associated with the event.
@@ -56,20 +67,119 @@ public:
         const std::optional<std::string>& callsign,
         const std::optional<int>& frequencyHz);
 
-    static void loopCleanup(
+    /**
+     * Updates the /transmitting response, called every frame from the render
+     * thread. Only builds a new body when the list changed.
+     */
+    void publishTransmitting(
         const std::vector<std::string>& liveReceivedCallsigns);
 
+    /**
+     * Queues a client event for the SDK event thread, which keeps the radio
+     * state cache current and forwards receptions to the websocket. Never
+     * waits on that thread, RX and PTT events are dropped if their queue is
+     * full.
+     */
+    void queueClientEvent(afv::ClientEvent event);
+
+    /**
+     * Whether the event thread does anything with events of this type:
+     * connection, PTT, RX and pilot RX changes. Check before copying an
+     * event for queueClientEvent().
+     */
+    [[nodiscard]] static bool wantsClientEvent(
+        afv_native::ClientEventType type);
+
+    [[nodiscard]] const afv::ClientEventQueue& getEventQueue() const
+    {
+        return pClientEvents;
+    }
+
+    [[nodiscard]] sdk::WebsocketRegistry::Stats getWebsocketStats() const
+    {
+        return pWebsockets.getStats();
+    }
+
 private:
+    // Bounds how late a wake up lost to a race with the consumer can be
+    static constexpr std::chrono::milliseconds kEventWaitTimeout { 20 };
+    static constexpr std::chrono::milliseconds kFrequencyStateCoalesceWindow {
+        50
+    };
+
+    afv::ClientEventQueue pClientEvents;
+    std::mutex pEventMutex;
+    std::condition_variable pEventCondition;
+    bool pStopEvents = false;
+    std::optional<std::chrono::steady_clock::time_point> pFrequencyStateDue;
+    uint64_t pReportedOverflows = 0;
+    std::thread pEventThread;
+
+    void runEventLoop();
+    void handleClientEvent(const afv::ClientEvent& event);
+
+    // Held while sending frequency state so that clients get the messages in
+    // sequence order
+    std::mutex pFrequencyStateMutex;
+    sdk::FrequencyStateTracker pFrequencyState;
+    // Whether the tracked state is from a voice session, nothing but the
+    // removals is sent otherwise
+    bool pFrequencyStateConnected = false;
+
+    void scheduleFrequencyStateUpdate();
+    void broadcastFrequencyStateChanges();
+
+    /**
+     * Registers a new websocket client and queues the full frequency state
+     * for it, ahead of any broadcast.
+     */
+    void addWebsocketClient(const restinio::websocket::basic::ws_handle_t& wsh);
+    void subscribeToFrequencyDeltas(uint64_t connectionId);
+    void sendFullFrequencyState(uint64_t connectionId);
+    // Called with pFrequencyStateMutex held
+    void queueFullFrequencyState(uint64_t connectionId);
+
+    // Bodies served by the HTTP endpoints, rebuilt when their state changes
+    sdk::CachedResponse pRxResponse;
+    sdk::CachedResponse pTxResponse;
+    sdk::CachedResponse pTransmittingResponse;
+    std::atomic<uint64_t> pStationsVersion = 0;
+
+    // Only touched by the render thread
+    std::vector<std::string> pLastTransmitting;
+    uint64_t pTransmittingVersion = 0;
+
+    /**
+     * The versions of everything the /rx and /tx bodies are built from.
+     */
+    [[nodiscard]] sdk::CacheKey stationStateKey() const;
+
+    /**
+     * Lists the stations in the form CALLSIGN:123.450, comma separated.
+     *
+     * @param tx list the stations transmitting instead of receiving
+     */
+    [[nodiscard]] std::string buildStationList(bool tx) const;
+
+    /**
+     * Answers with the body, or with 304 Not Modified if the client already
+     * has it.
+     */
+    static restinio::request_handling_status_t respondCached(
+        const restinio::request_handle_t& req,
+        const std::shared_ptr<const sdk::CachedBody>& body);
+
     using serverTraits = restinio::traits_t<restinio::asio_timer_manager_t,
         restinio::null_logger_t, restinio::router::express_router_t<>>;
 
+    // Runs the server and the websocket writes, outlives both
+    restinio::asio_ns::io_context pIoContext;
     restinio::running_server_handle_t<serverTraits> pSDKServer;
     std::shared_ptr<afv_native::api::atcClient> pClient;
+    std::shared_ptr<afv::RadioStateCache> pRadioState;
+    int pStationListener = 0;
 
-    using ws_registry_t
-        = std::map<std::uint64_t, restinio::websocket::basic::ws_handle_t>;
-
-    ws_registry_t pWsRegistry;
+    sdk::WebsocketRegistry pWebsockets { pIoContext };
 
     enum sdkCall {
         kTransmitting,
@@ -85,11 +195,14 @@ private:
     /**
      * @brief Broadcasts data on the websocket.
      *
-     * This function sends the provided data on the websocket connection.
+     * This function queues the provided data for every websocket connection,
+     * it is written from the server threads.
      *
      * @param data The data to be broadcasted in JSON format.
+     * @param delivery Whether the data may be dropped for a slow client.
      */
-    void broadcastOnWebsocket(const std::string& data);
+    void broadcastOnWebsocket(
+        std::string data, sdk::WebsocketRegistry::Delivery delivery);
 
     /**
      * @brief Builds the server.
@@ -113,7 +226,7 @@ private:
      * @param req The request handle.
      * @return The status of request handling.
      */
-    static restinio::request_handling_status_t handleTransmittingSDKCall(
+    restinio::request_handling_status_t handleTransmittingSDKCall(
         const restinio::request_handle_t& req);
 
     /**
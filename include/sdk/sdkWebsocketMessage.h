@@ -10,13 +10,20 @@ namespace vector_audio::sdk::types {
 enum class WebsocketMessageType {
     kRxBegin,
     kRxEnd,
-    kFrequencyStateUpdate
+    kFrequencyStateUpdate,
+    kFrequencyStateDelta,
+    kFrequencyStateResync,
+    kFrequencyStateSubscribeDeltas
 };
 
 const std::map<WebsocketMessageType, std::string> kWebsocketMessageTypeMap {
     { WebsocketMessageType::kRxBegin, "kRxBegin" },
     { WebsocketMessageType::kRxEnd, "kRxEnd" },
-    { WebsocketMessageType::kFrequencyStateUpdate, "kFrequenciesUpdate" }
+    { WebsocketMessageType::kFrequencyStateUpdate, "kFrequenciesUpdate" },
+    { WebsocketMessageType::kFrequencyStateDelta, "kFrequenciesDelta" },
+    { WebsocketMessageType::kFrequencyStateResync, "kFrequenciesResync" },
+    { WebsocketMessageType::kFrequencyStateSubscribeDeltas,
+        "kFrequenciesSubscribeDeltas" }
 };
 
 class WebsocketMessage {
@@ -57,10 +64,30 @@ public:
 // "pFrequencyHz": 123000000}}
 
 //
-// Example of kFrequencyStateUpdate message:
+// Example of kFrequencyStateUpdate message, sent on connection, on resync and,
+// unless the client subscribed to deltas, on every change:
 // @type the type of the message
 // @value the frequency state update information including rx, tx, and xc
-// stations
-// JSON: {"type": "kFrequencyStateUpdate", "value": {"rx":
+// stations, and the sequence number of the last change it includes
+// JSON: {"type": "kFrequencyStateUpdate", "value": {"seq": 12, "rx":
 // [{"pFrequencyHz": 118775000, "pCallsign": "EDDF_S_TWR"}], "tx": [{"pFrequencyHz": 119775000, "pCallsign": "EDDF_S_TWR"}], "xc":
 // [{"pFrequencyHz": 121500000, "pCallsign": "EDDF_S_TWR"}]}}
+
+// Example of kFrequenciesDelta message, sent when the state changes to the
+// clients that subscribed to deltas:
+// @type the type of the message
+// @value the stations added to and removed from each of rx, tx and xc since
+// the previous message. seq is one more than the previous message's, a client
+// seeing a gap should ask for a resync
+// JSON: {"type": "kFrequenciesDelta", "value": {"seq": 13, "rx": {"added":
+// [{"pFrequencyHz": 118775000, "pCallsign": "EDDF_S_TWR"}], "removed": []},
+// "tx": {"added": [], "removed": []}, "xc": {"added": [], "removed": []}}}
+
+// Example of kFrequenciesResync message, sent by a client to get a full
+// kFrequencyStateUpdate:
+// JSON: {"type": "kFrequenciesResync"}
+
+// Example of kFrequenciesSubscribeDeltas message, sent by a client to get
+// kFrequenciesDelta messages instead of a kFrequencyStateUpdate on every
+// change. Answered with a kFrequencyStateUpdate to apply the deltas to:
+// JSON: {"type": "kFrequenciesSubscribeDeltas"}
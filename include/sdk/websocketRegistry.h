@@ -0,0 +1,144 @@
+#pragma once
+#include <restinio/all.hpp>
+#include <restinio/websocket/message.hpp>
+#include <restinio/websocket/websocket.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace vector_audio::sdk {
+
+/**
+ * The connected websocket clients, safe to use from any thread.
+ *
+ * Messages are queued per client and written from the server's io_context,
+ * so a broadcast never waits on a socket and a slow client only delays
+ * itself. At most kMaxInFlight messages per client are handed to restinio
+ * at a time, the next ones wait in the client's queue until a write
+ * completes. That queue is bounded: once full, the oldest droppable message
+ * goes, which clients notice as a gap in the frequency state sequence
+ * numbers and recover from with a resync. A client whose queue is full of
+ * messages that cannot be dropped is evicted, as are clients that stop
+ * answering pings.
+ */
+class WebsocketRegistry {
+public:
+    static constexpr size_t kMaxQueuedMessages = 64;
+    static constexpr size_t kMaxInFlight = 4;
+    static constexpr std::chrono::seconds kPingInterval { 15 };
+    // Also covers clients that went away without a close frame
+    static constexpr std::chrono::seconds kIdleTimeout { 45 };
+
+    enum class Delivery {
+        // Dropped when the queue is full, for messages the client can recover
+        // from losing such as frequency state deltas
+        kDroppable,
+        // Never dropped, for messages nothing would resend such as RX begin
+        // and end
+        kReliable,
+        // Replaces the queued kLatestWins message instead of adding one, for
+        // messages holding a full state. Otherwise never dropped
+        kLatestWins,
+    };
+
+    // Which clients a broadcast goes to
+    enum class Audience {
+        kEveryone,
+        // Clients that get the full frequency state on every change
+        kFullState,
+        // Clients that asked for frequency state deltas instead
+        kDeltas,
+    };
+
+    struct Stats {
+        size_t clients = 0;
+        uint64_t dropped = 0;
+        uint64_t evicted = 0;
+    };
+
+    explicit WebsocketRegistry(restinio::asio_ns::io_context& ioContext);
+
+    WebsocketRegistry(const WebsocketRegistry&) = delete;
+    WebsocketRegistry& operator=(const WebsocketRegistry&) = delete;
+
+    void add(const restinio::websocket::basic::ws_handle_t& wsh);
+    void remove(uint64_t id);
+
+    /**
+     * Records that the client sent something, any frame counts as an answer
+     * to a ping.
+     */
+    void touch(uint64_t id);
+
+    /**
+     * Moves the client to the kDeltas audience, for good.
+     */
+    void subscribeDeltas(uint64_t id);
+
+    void send(uint64_t id, std::string payload, Delivery delivery);
+    void broadcast(std::string payload, Delivery delivery,
+        Audience audience = Audience::kEveryone);
+
+    /**
+     * Pings the idle clients and evicts the ones past kIdleTimeout. Meant to
+     * be called often, it only looks at the clients once a second.
+     */
+    void sweep(std::chrono::steady_clock::time_point now);
+
+    /**
+     * Closes every connection, for shutdown.
+     */
+    void closeAll();
+
+    [[nodiscard]] Stats getStats() const;
+
+private:
+    struct Message {
+        restinio::websocket::basic::opcode_t opcode
+            = restinio::websocket::basic::opcode_t::text_frame;
+        // Shared between the queues of a broadcast
+        std::shared_ptr<const std::string> payload;
+        Delivery delivery = Delivery::kDroppable;
+    };
+
+    struct Client {
+        uint64_t id = 0;
+        restinio::websocket::basic::ws_handle_t wsh;
+        std::atomic<bool> wantsDeltas = false;
+
+        std::mutex mutex;
+        std::deque<Message> queue;
+        // Handed to restinio and not written yet
+        size_t inFlight = 0;
+        // Set while a flush is posted or running, so one thread at a time
+        // writes to the client and messages keep their order
+        bool flushing = false;
+        std::chrono::steady_clock::time_point lastSeen;
+        std::chrono::steady_clock::time_point lastPing;
+    };
+
+    std::shared_ptr<Client> find(uint64_t id) const;
+    void enqueue(const std::shared_ptr<Client>& client, Message message);
+    void flush(const std::shared_ptr<Client>& client);
+    void writeCompleted(const std::shared_ptr<Client>& client,
+        const restinio::asio_ns::error_code& ec);
+    void evict(uint64_t id);
+
+    restinio::asio_ns::io_context& pIoContext;
+
+    mutable std::mutex pMutex;
+    std::map<uint64_t, std::shared_ptr<Client>> pClients;
+    std::chrono::steady_clock::time_point pLastSweep;
+    uint64_t pReportedDropped = 0;
+
+    std::atomic<uint64_t> pDropped = 0;
+    std::atomic<uint64_t> pEvicted = 0;
+};
+}
@@ -1,9 +1,13 @@
 #pragma once
 #include "ns/station.h"
+#include "ns/station_registry.h"
 
 #include <afv-native/hardwareType.h>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <neargye/semver.hpp>
 #include <SFML/Audio/SoundBuffer.hpp>
@@ -18,7 +22,8 @@
 #define slurper_url "/users/info/?cid="
 
 #define url_regex                                                              \
-    "^(https?:\\/\\/)?(?:[^@\n]+@)?(?:www\\.)?([^:\\/\n?]+)(\\/[.A-z0-9/-]+)$"
+    "^(https?:\\/\\/)?(?:[^@\n]+@)?(?:www\\.)?([^:\\/\n?]+(?::[0-9]+)?)"       \
+    "(\\/[.A-z0-9/-]+)$"
 
 namespace vector_audio::shared {
 
@@ -33,7 +38,9 @@ inline std::string vatsimPassword;
 inline int defaultTransceiverPositionElevation = 300;
 inline int defaultSUPTransceiverPositionElevation = 1000;
 inline int airportTransceiverElevationOffset = 33;
+inline double nearestAirportMaxDistanceKm = 50.0;
 inline bool keepWindowOnTop = false;
+inline bool isWindowFocused = true;
 
 const int kObsFrequency = 199998000; // 199.998
 const int kUnicomFrequency = 122800000;
@@ -51,10 +58,10 @@ inline sf::Keyboard::Scancode ptt = sf::Keyboard::Scan::Unknown;
 inline sf::Keyboard::Key fallbackPtt = sf::Keyboard::Unknown;
 inline int joyStickId = -1;
 inline int joyStickPtt = -1;
-inline bool isPttOpen = false;
+// Written by the PTT thread
+inline std::atomic<bool> isPttOpen = false;
 
-inline std::mutex fetchedStationMutex;
-inline std::vector<ns::Station> fetchedStations;
+inline ns::StationRegistry stations;
 
 inline bool bootUpVccs = false;
 
@@ -78,23 +85,53 @@ inline std::map<unsigned int, std::string> availableAudioAPI;
 inline std::vector<std::string> availableInputDevices;
 inline std::vector<std::string> availableOutputDevices;
 
-inline static std::mutex transmittingMutex;
-inline static std::string currentlyTransmittingApiData;
-inline static std::chrono::high_resolution_clock::time_point
-    currentlyTransmittingApiTimer;
-
 inline int apiServerPort = 49080;
 
-// Thread unsafe stuff
 namespace session {
-    inline std::mutex m;
-    inline int facility = 0;
-    inline bool isConnected = false;
-
-    inline double latitude;
-    inline double longitude;
-
-    inline std::string callsign = "Not connected";
-    inline int frequency;
+    /**
+     * The VATSIM session as last seen by the data handler. A snapshot is
+     * never modified once published, readers on any thread take a reference
+     * with get() and keep a consistent view for as long as they hold it.
+     */
+    struct SessionSnapshot {
+        // Incremented on every publication
+        uint64_t version = 0;
+
+        bool isConnected = false;
+        std::string callsign = "Not connected";
+        int facility = 0;
+        int frequency = 0;
+
+        double latitude = 0.0;
+        double longitude = 0.0;
+    };
+
+    // Only ever accessed through std::atomic_load and std::atomic_store
+    inline std::shared_ptr<const SessionSnapshot> current
+        = std::make_shared<const SessionSnapshot>();
+    // Serialises writers only, never held during I/O
+    inline std::mutex writeMutex;
+
+    inline std::shared_ptr<const SessionSnapshot> get()
+    {
+        return std::atomic_load(&current);
+    }
+
+    /**
+     * Publishes a copy of the current snapshot modified by fn, which must
+     * not block.
+     */
+    template <typename Fn>
+    std::shared_ptr<const SessionSnapshot> update(Fn&& fn)
+    {
+        const std::lock_guard<std::mutex> l(writeMutex);
+        auto next = std::make_shared<SessionSnapshot>(*get());
+        fn(*next);
+        next->version++;
+
+        std::shared_ptr<const SessionSnapshot> published = std::move(next);
+        std::atomic_store(&current, published);
+        return published;
+    }
+}
 }
-}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace vector_audio::ui {
+
+/**
+ * Decides when the main loop draws a frame.
+ *
+ * Frames are drawn at the active rate while something is changing on screen:
+ * for a short while after any input or wake(), or for as long as the
+ * application asks for continuous frames. Otherwise the window is only redrawn
+ * once per idle interval, and the loop sleeps in between.
+ *
+ * SFML 2 cannot wait for window events with a timeout, nor be woken from
+ * another thread while doing so, so the loop still looks at its events every
+ * kEventPollInterval but never draws unless a frame is due.
+ */
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // 30 fps, the previous fixed frame rate
+    static constexpr std::chrono::milliseconds kActiveFrameInterval { 33 };
+    // Keeps clocks and connection status current while idle
+    static constexpr std::chrono::milliseconds kIdleFrameInterval { 1000 };
+    static constexpr std::chrono::milliseconds kEventPollInterval { 50 };
+    // Lets hover effects and popups settle after the last input
+    static constexpr std::chrono::milliseconds kActivityLinger { 500 };
+
+    struct Stats {
+        // Smoothed durations of the last frames, in milliseconds
+        float cpuMs = 0.0F;
+        float gpuMs = 0.0F;
+        float framesPerSecond = 0.0F;
+        bool idle = false;
+    };
+
+    /**
+     * Requests frames at the active rate for a little while, wakes the loop
+     * if it is sleeping. Thread safe.
+     */
+    void wake();
+
+    /**
+     * Keeps drawing at the active rate for as long as this is set, for
+     * content that changes without any event, like the VU meter.
+     */
+    void setContinuous(bool continuous);
+
+    /**
+     * Sleeps until either a frame is due, a wake up is requested, or window
+     * events should be polled again.
+     *
+     * @return true if a frame should be drawn now
+     */
+    bool waitForFrame();
+
+    /**
+     * Records the duration of the frame that was just drawn.
+     *
+     * @param cpu time spent building and submitting the frame
+     * @param gpu time spent presenting it, which is where the driver waits
+     * for the GPU to catch up
+     */
+    void frameDrawn(Clock::duration cpu, Clock::duration gpu);
+
+    [[nodiscard]] const Stats& getStats() const { return pStats; }
+
+private:
+    std::mutex pMutex;
+    std::condition_variable pWakeCondition;
+    bool pWoken = false;
+    Clock::time_point pActiveUntil;
+
+    // Only used by the main loop
+    bool pContinuous = false;
+    Clock::time_point pLastFrame;
+    Clock::time_point pStatsWindowStart = Clock::now();
+    int pStatsWindowFrames = 0;
+    Stats pStats;
+};
+}
@@ -21,12 +21,24 @@ protected:
         | ImGuiInputTextFlags_CharsUppercase;
 
 public:
-    static void Draw(
-        bool isVoiceConnected, const std::function<void(std::string)>& addCallback)
+    static void Draw(bool isVoiceConnected,
+        const std::string& pendingLookupCallsign,
+        const std::function<void(std::string)>& addCallback,
+        const std::function<void()>& cancelCallback)
     {
         ImGui::PushItemWidth(-1.0);
         ImGui::Text("Add station");
 
+        if (!pendingLookupCallsign.empty()) {
+            // A pilot lookup is running in the background
+            ImGui::TextWrapped("Looking up %s...", pendingLookupCallsign.c_str());
+            if (ImGui::Button("Cancel##PilotLookup", ImVec2(-FLT_MIN, 0.0))) {
+                std::invoke(cancelCallback);
+            }
+            ImGui::PopItemWidth();
+            return;
+        }
+
         style::push_disabled_on(!isVoiceConnected);
         if (ImGui::InputText("Callsign##Auto",
                 &AddStationWidget::mStationCallsignInputString, kStationAddInputFlags)
@@ -5,6 +5,9 @@
 #include "shared.h"
 #include "ui/style.h"
 
+#include <algorithm>
+#include <chrono>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -13,7 +16,10 @@ class NetworkStatusWidget {
 
 public:
     static void Draw(bool isVoiceConnected, bool isSlurperAvailable,
-        bool isDatafileAvailable)
+        bool isDatafileAvailable,
+        std::optional<std::chrono::milliseconds> slurperLatency,
+        const std::vector<vatsim::MirrorTracker::Health>& mirrors,
+        std::chrono::seconds pollInterval, std::chrono::seconds nextPollIn)
     {
 
         ImGui::TextColored(isVoiceConnected ? kGreen : kRed, "API");
@@ -26,16 +32,44 @@ public:
         ImGui::SameLine();
         // Status about datasource
 
+        ImGui::BeginGroup();
         if (isSlurperAvailable) {
             ImGui::TextColored(kGreen, "Slurper");
+            drawLatency(slurperLatency);
             /*if (ImGui::IsItemClicked()) {
                 shared::slurper::is_unavailable = true;
             }*/
         } else if (isDatafileAvailable) {
             ImGui::TextColored(kYellow, "Datafile");
+            for (const auto& mirror : mirrors) {
+                if (mirror.current) {
+                    drawLatency(mirror.latency);
+                }
+            }
         } else {
             ImGui::TextColored(kRed, "No VATSIM Data");
         }
+        ImGui::EndGroup();
+
+        if (ImGui::IsItemHovered()) {
+            ImGui::BeginTooltip();
+            ImGui::Text("Checking every %llds, next check in %llds",
+                static_cast<long long>(pollInterval.count()),
+                static_cast<long long>(
+                    std::max(nextPollIn, std::chrono::seconds(0)).count()));
+
+            for (const auto& mirror : mirrors) {
+                ImGui::TextColored(mirror.healthy ? kGreen : kRed,
+                    "%s%s: %s, %.0f%% errors", mirror.current ? "> " : "",
+                    mirror.host.c_str(),
+                    mirror.latency
+                        ? (std::to_string(mirror.latency->count()) + "ms")
+                              .c_str()
+                        : "not probed",
+                    mirror.errorRate * 100.0);
+            }
+            ImGui::EndTooltip();
+        }
 
         ImGui::SameLine();
 
@@ -47,6 +81,16 @@ public:
     }
 
 private:
+    static void drawLatency(std::optional<std::chrono::milliseconds> latency)
+    {
+        if (!latency) {
+            return;
+        }
+
+        ImGui::SameLine();
+        ImGui::TextDisabled("%lldms", static_cast<long long>(latency->count()));
+    }
+
     constexpr static const ImVec4 kRed = { 1.0, 0.0, 0.0, 1.0 };
     constexpr static const ImVec4 kYellow = ImVec4(1.0, 1.0, 0.0, 1.0);
     constexpr static const ImVec4 kGreen = ImVec4(0.0, 1.0, 0.0, 1.0);
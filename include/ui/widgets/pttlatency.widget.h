@@ -0,0 +1,52 @@
+#pragma once
+#include "imgui.h"
+#include "native/ptt_monitor.h"
+
+#include <array>
+#include <string>
+
+namespace vector_audio::ui::widgets {
+class PttLatencyWidget {
+
+public:
+    /**
+     * Shows how long PTT changes took to reach the client, in milliseconds.
+     */
+    static void Draw(const native::LatencyHistogram& latency,
+        const std::string& backendName)
+    {
+        using Histogram = native::LatencyHistogram;
+
+        ImGui::Text("PTT (%s): %llu changes", backendName.c_str(),
+            static_cast<unsigned long long>(latency.total()));
+        if (latency.total() == 0) {
+            return;
+        }
+
+        const auto counts = latency.counts();
+        std::array<float, Histogram::kBucketLimitsUs.size()> values {};
+        for (size_t i = 0; i < counts.size(); i++) {
+            values[i] = static_cast<float>(counts[i]);
+        }
+        ImGui::PlotHistogram("##ptt_latency", values.data(),
+            static_cast<int>(values.size()), 0, nullptr, 0.0F, FLT_MAX,
+            ImVec2(240.0F, 40.0F));
+        ImGui::TextDisabled("%s .. %s ms", Histogram::kBucketLabels[0],
+            Histogram::kBucketLabels[counts.size() - 1]);
+
+        drawPercentile("p50", latency.percentileMs(0.5F));
+        ImGui::SameLine();
+        drawPercentile("p99", latency.percentileMs(0.99F));
+    }
+
+private:
+    static void drawPercentile(const char* label, float ms)
+    {
+        if (ms < 0.0F) {
+            ImGui::Text("%s > 50ms", label);
+        } else {
+            ImGui::Text("%s < %.1fms", label, ms);
+        }
+    }
+};
+}
@@ -2,6 +2,7 @@
 #include "absl/strings/match.h"
 #include "httplib.h"
 #include "imgui.h"
+#include "net/http_client_pool.h"
 #include "platform_folders.h"
 #include "shared.h"
 #include "spdlog/spdlog.h"
@@ -40,8 +41,6 @@ private:
     std::string pBetaVersionUrl = "/pierr3/VectorAudio/main/VERSION_BETA";
     semver::version pNewVersion;
     semver::version pBetaVersion;
-
-    httplib::Client pCli;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+namespace vector_audio::vatsim {
+
+/**
+ * The few fields we care about for a single pilot or controller entry of the
+ * v3 datafile.
+ */
+struct DatafileRecord {
+    std::string callsign;
+    int cid = 0;
+    int facility = 0;
+    std::string frequency;
+    double latitude = 0.0;
+    double longitude = 0.0;
+};
+
+/**
+ * Incremental scanner for the VATSIM v3 datafile.
+ *
+ * Chunks are fed in as they arrive from the network. The scanner only tracks
+ * string state, nesting depth and top-level keys, it never builds a DOM.
+ * Elements of the requested sections are handed to the handler as raw JSON
+ * text, all other sections (usually the multi-megabyte pilots array) are
+ * skipped byte by byte.
+ */
+class DatafileStreamParser {
+public:
+    enum class Section { kOther, kGeneral, kPilots, kControllers };
+
+    // Return false from the handler to stop scanning straight away
+    using ElementHandler = std::function<bool(Section, std::string_view)>;
+
+    DatafileStreamParser(
+        std::initializer_list<Section> sections, ElementHandler handler);
+
+    /**
+     * Feeds the next chunk of the datafile.
+     *
+     * @return false once no more data is needed, either because the handler
+     * asked to stop, the document is complete or it is malformed.
+     */
+    bool feed(const char* data, size_t length);
+
+    [[nodiscard]] bool isStopped() const { return pStopped; }
+    [[nodiscard]] bool isComplete() const { return pComplete; }
+    [[nodiscard]] bool isMalformed() const { return pMalformed; }
+
+    [[nodiscard]] size_t bytesScanned() const { return pBytesScanned; }
+    [[nodiscard]] std::chrono::microseconds parseTime() const
+    {
+        return pParseTime;
+    }
+
+    /**
+     * Extracts the top-level fields of a single pilot or controller element
+     * without building a DOM for it.
+     */
+    static bool parseRecord(std::string_view element, DatafileRecord& out);
+
+private:
+    ElementHandler pHandler;
+    std::array<bool, 4> pWanted {};
+
+    int pDepth = 0;
+    bool pInString = false;
+    bool pEscape = false;
+    bool pExpectKey = false;
+    bool pReadingKey = false;
+    std::string pKey;
+    Section pSection = Section::kOther;
+
+    bool pCapturing = false;
+    int pCaptureDepth = 0;
+    std::string pElement;
+
+    bool pStopped = false;
+    bool pComplete = false;
+    bool pMalformed = false;
+
+    size_t pBytesScanned = 0;
+    std::chrono::microseconds pParseTime { 0 };
+
+    [[nodiscard]] bool isWanted(Section section) const
+    {
+        return pWanted[static_cast<size_t>(section)];
+    }
+
+    static Section sectionForKey(const std::string& key);
+};
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include "vatsim/datafile_parser.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace vector_audio::vatsim {
+
+/**
+ * Indexed copy of a single datafile fetch.
+ *
+ * A snapshot is filled while the datafile is streamed in, then published as a
+ * shared_ptr to const and never modified again, so any number of threads can
+ * read from it without locking. The indexes themselves are shared between
+ * renewed copies, so an unchanged datafile does not need to be re-indexed.
+ *
+ * The session watcher only needs its own controller entry, so its snapshots
+ * skip the pilots and may stop at that entry. Pilots are only indexed once a
+ * lookup asks for them.
+ */
+class DatafileSnapshot {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    DatafileSnapshot(Clock::duration ttl, bool withPilots);
+
+    /**
+     * Adds an element handed out by the DatafileStreamParser, only valid
+     * while the snapshot is being built.
+     */
+    bool addElement(DatafileStreamParser::Section section,
+        std::string_view element);
+
+    /**
+     * Returns a copy sharing the same data but fetched now, used when the
+     * server tells us the datafile has not changed.
+     */
+    [[nodiscard]] std::shared_ptr<const DatafileSnapshot> renewed() const;
+
+    /**
+     * Records whether the whole controllers section was read, false when the
+     * scan stopped early. Only valid while the snapshot is being built.
+     */
+    void setControllersComplete(bool complete);
+
+    /**
+     * Whether the snapshot can answer a lookup of the given controller CID,
+     * and of pilots if asked for, without fetching the datafile again.
+     */
+    [[nodiscard]] bool covers(int cid, bool withPilots) const;
+
+    [[nodiscard]] bool isFresh() const
+    {
+        return Clock::now() - pFetchedAt < pTtl;
+    }
+
+    [[nodiscard]] const std::string& getUpdateTimestamp() const
+    {
+        return pIndex->updateTimestamp;
+    }
+
+    [[nodiscard]] Clock::time_point getFetchedAt() const { return pFetchedAt; }
+
+    [[nodiscard]] size_t pilotCount() const { return pIndex->pilots.size(); }
+    [[nodiscard]] size_t controllerCount() const
+    {
+        return pIndex->controllers.size();
+    }
+
+    // Lookups return nullptr if the entry is not in the snapshot
+    [[nodiscard]] const DatafileRecord* findPilot(
+        const std::string& callsign) const;
+    [[nodiscard]] const DatafileRecord* findPilotByCid(int cid) const;
+    [[nodiscard]] const DatafileRecord* findController(
+        const std::string& callsign) const;
+    [[nodiscard]] const DatafileRecord* findControllerByCid(int cid) const;
+
+private:
+    struct Index {
+        std::string updateTimestamp;
+        bool withPilots = false;
+        bool controllersComplete = false;
+
+        std::vector<DatafileRecord> pilots;
+        std::vector<DatafileRecord> controllers;
+
+        std::unordered_map<std::string, size_t> pilotsByCallsign;
+        std::unordered_map<int, size_t> pilotsByCid;
+        std::unordered_map<std::string, size_t> controllersByCallsign;
+        std::unordered_map<int, size_t> controllersByCid;
+    };
+
+    Clock::time_point pFetchedAt;
+    Clock::duration pTtl;
+    std::shared_ptr<Index> pIndex;
+
+    static const DatafileRecord* find(const std::vector<DatafileRecord>& list,
+        const std::unordered_map<std::string, size_t>& index,
+        const std::string& key);
+    static const DatafileRecord* find(const std::vector<DatafileRecord>& list,
+        const std::unordered_map<int, size_t>& index, int key);
+};
+}
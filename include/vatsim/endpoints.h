@@ -0,0 +1,40 @@
+#pragma once
+#include "shared.h"
+
+#include <string>
+#include <toml.hpp>
+
+namespace vector_audio::vatsim {
+
+/**
+ * Where the data handler looks for VATSIM data. Defaults to the live
+ * network, can be pointed at a local stand-in server through the [endpoints]
+ * section of the config file.
+ */
+struct Endpoints {
+    std::string statusHost = vatsim_status_host;
+    std::string statusPath = vatsim_status_url;
+    std::string slurperHost = slurper_host;
+    std::string slurperPath = slurper_url;
+
+    static Endpoints fromConfig(const toml::value& config)
+    {
+        Endpoints endpoints;
+        endpoints.statusHost = toml::find_or<std::string>(
+            config, "endpoints", "status_host", endpoints.statusHost);
+        endpoints.statusPath = toml::find_or<std::string>(
+            config, "endpoints", "status_path", endpoints.statusPath);
+        endpoints.slurperHost = toml::find_or<std::string>(
+            config, "endpoints", "slurper_host", endpoints.slurperHost);
+        endpoints.slurperPath = toml::find_or<std::string>(
+            config, "endpoints", "slurper_path", endpoints.slurperPath);
+        return endpoints;
+    }
+
+    [[nodiscard]] bool isLive() const
+    {
+        return statusHost == vatsim_status_host
+            && slurperHost == slurper_host;
+    }
+};
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vector_audio::vatsim {
+using namespace std::chrono_literals;
+
+struct Mirror {
+    std::string host;
+    std::string path;
+
+    bool operator==(const Mirror& other) const
+    {
+        return host == other.host && path == other.path;
+    }
+};
+
+/**
+ * Keeps track of how well each datafile mirror listed in status.json is
+ * doing.
+ *
+ * Every mirror has an exponentially weighted moving average of its latency,
+ * measured by cheap HEAD probes (or a one byte ranged GET where HEAD is not
+ * supported), and of its error rate, fed by both probes and real downloads.
+ * The fastest healthy mirror is the one in use, so a failing mirror is
+ * replaced as soon as its error rate crosses kUnhealthyErrorRate.
+ */
+class MirrorTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Health {
+        std::string host;
+        std::optional<std::chrono::milliseconds> latency;
+        double errorRate = 0.0;
+        bool healthy = true;
+        bool current = false;
+    };
+
+    // Weight of the newest sample in the moving averages
+    static constexpr double kAlpha = 0.3;
+    static constexpr double kUnhealthyErrorRate = 0.5;
+    static constexpr auto kProbeTimeout = 2s;
+    static constexpr auto kProbeInterval = 5min;
+
+    /**
+     * Replaces the list of mirrors, keeping the history of the ones that
+     * were already known.
+     */
+    void setMirrors(std::vector<Mirror> mirrors);
+
+    // Probes every mirror in parallel, blocks until they have all answered
+    // or timed out
+    void probeAll();
+
+    [[nodiscard]] bool isProbeDue() const;
+
+    // Whether at least one mirror answered the last time we contacted it
+    [[nodiscard]] bool hasReachableMirror() const;
+
+    // The fastest healthy mirror, or the least bad one if none is healthy
+    [[nodiscard]] std::optional<Mirror> current() const;
+
+    // Every mirror, best first, to fail over within a single download
+    [[nodiscard]] std::vector<Mirror> ranked() const;
+
+    void recordSuccess(const Mirror& mirror,
+        std::optional<std::chrono::milliseconds> latency = std::nullopt);
+    void recordFailure(const Mirror& mirror);
+
+    [[nodiscard]] std::vector<Health> getHealth() const;
+
+private:
+    struct Entry {
+        Mirror mirror;
+        std::optional<double> latencyMs;
+        double errorRate = 0.0;
+        bool reachable = false;
+    };
+
+    mutable std::mutex pMutex;
+    std::vector<Entry> pEntries;
+    std::optional<Clock::time_point> pLastProbe;
+
+    // Caller holds pMutex
+    [[nodiscard]] const Entry* best() const;
+    [[nodiscard]] static std::pair<int, double> score(const Entry& entry);
+    Entry* find(const Mirror& mirror);
+
+    static bool isHealthy(const Entry& entry)
+    {
+        return entry.errorRate < kUnhealthyErrorRate;
+    }
+};
+}
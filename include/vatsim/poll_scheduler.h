@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+
+namespace vector_audio::vatsim {
+using namespace std::chrono_literals;
+
+/**
+ * Decides when the session watcher polls VATSIM next.
+ *
+ * Polls are fast for a short while after the user asks to connect or after a
+ * missed poll, regular while connected, and slow while idle, even more so
+ * when the window is in the background. Failing endpoints back off
+ * exponentially, with some jitter so clients do not retry in lockstep.
+ */
+class PollScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Outcome {
+        kConnected,
+        kNotConnected,
+        kError // No endpoint could be reached
+    };
+
+    static constexpr auto kFastInterval = 3s;
+    static constexpr auto kConnectedInterval = 15s;
+    static constexpr auto kIdleInterval = 30s;
+    static constexpr auto kUnfocusedInterval = 60s;
+    static constexpr auto kMaxBackoff = 120s;
+    static constexpr int kFastPolls = 5;
+    static constexpr double kJitter = 0.2;
+
+    PollScheduler();
+
+    // Polls the next few rounds at kFastInterval
+    void requestFastPolling(int polls = kFastPolls);
+
+    void setFocused(bool focused) { pFocused = focused; }
+
+    /**
+     * Records the outcome of a poll and schedules the next one.
+     *
+     * @param floor the next poll will not happen sooner than this, used when
+     * polling earlier could not return newer data.
+     * @return the interval until the next poll.
+     */
+    Clock::duration schedule(Outcome outcome, Clock::duration floor = {});
+
+    [[nodiscard]] Clock::duration getInterval() const;
+    [[nodiscard]] Clock::time_point getNextPollAt() const;
+
+private:
+    mutable std::mutex pMutex;
+    std::mt19937 pRng;
+
+    std::atomic<bool> pFocused = true;
+    int pFastPollsLeft = 0;
+    int pFailures = 0;
+
+    Clock::duration pInterval = kIdleInterval;
+    Clock::time_point pNextPollAt;
+
+    Clock::duration backoff();
+};
+}
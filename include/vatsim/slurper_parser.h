@@ -0,0 +1,98 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace vector_audio::vatsim {
+
+namespace detail {
+    constexpr uint32_t packSuffix(std::string_view suffix)
+    {
+        return (static_cast<uint32_t>(static_cast<unsigned char>(suffix[0]))
+                   << 16U)
+            | (static_cast<uint32_t>(static_cast<unsigned char>(suffix[1]))
+                << 8U)
+            | static_cast<uint32_t>(static_cast<unsigned char>(suffix[2]));
+    }
+}
+
+/**
+ * One line of the slurper CSV, every field is a view into the downloaded
+ * body so nothing is allocated while parsing.
+ */
+struct SlurperEntry {
+    std::string_view cid;
+    std::string_view callsign;
+    std::string_view type;
+    std::string_view frequency;
+    std::string_view facility;
+    std::string_view latitude;
+    std::string_view longitude;
+};
+
+class SlurperParser {
+public:
+    // cid, callsign, type, frequency, facility, latitude, longitude
+    static constexpr size_t kMinFields = 7;
+
+    /**
+     * Returns the next line of the body and advances past it, trailing \r
+     * included.
+     *
+     * @return false once the body is exhausted.
+     */
+    static bool nextLine(std::string_view& data, std::string_view& line);
+
+    /**
+     * Splits a line into its fields.
+     *
+     * @return false if the line does not have enough fields, in which case
+     * the entry must not be used.
+     */
+    static bool splitLine(std::string_view line, SlurperEntry& out);
+
+    // Parses "118.650" as 118650, returns false on anything else than digits
+    // and dots
+    static bool parseFrequencyKhz(std::string_view field, int& out);
+
+    static bool parseDouble(std::string_view field, double& out);
+
+    static constexpr bool endsWith(
+        std::string_view value, std::string_view suffix)
+    {
+        return value.size() >= suffix.size()
+            && value.substr(value.size() - suffix.size()) == suffix;
+    }
+
+    /**
+     * Whether the callsign ends with one of the controller suffixes allowed
+     * to transmit, e.g. _TWR or _CTR.
+     */
+    static constexpr bool hasTransmittingSuffix(std::string_view callsign)
+    {
+        if (callsign.size() < 4 || callsign[callsign.size() - 4] != '_') {
+            return false;
+        }
+
+        // All suffixes are three letters long, so each one packs into a
+        // single integer and the lookup compiles down to a switch
+        switch (detail::packSuffix(callsign.substr(callsign.size() - 3))) {
+        case detail::packSuffix("CTR"):
+        case detail::packSuffix("APP"):
+        case detail::packSuffix("TWR"):
+        case detail::packSuffix("GND"):
+        case detail::packSuffix("DEL"):
+        case detail::packSuffix("FSS"):
+        case detail::packSuffix("SUP"):
+        case detail::packSuffix("RDO"):
+        case detail::packSuffix("RMP"):
+        case detail::packSuffix("TMU"):
+        case detail::packSuffix("FMP"):
+            return true;
+        default:
+            return false;
+        }
+    }
+};
+}
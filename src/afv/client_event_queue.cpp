@@ -0,0 +1,109 @@
+#include "afv/client_event_queue.h"
+
+#include <map>
+
+namespace vector_audio::afv {
+
+ClientEvent ClientEvent::fromCallback(
+    afv_native::ClientEventType type, void* data, void* data2)
+{
+    using afv_native::ClientEventType;
+
+    ClientEvent event;
+    event.type = type;
+
+    switch (type) {
+    case ClientEventType::RxOpen:
+    case ClientEventType::RxClosed:
+        if (data != nullptr) {
+            event.frequencyHz
+                = static_cast<int>(*reinterpret_cast<unsigned int*>(data));
+        }
+        break;
+    case ClientEventType::PilotRxOpen:
+    case ClientEventType::PilotRxClosed:
+        if (data != nullptr && data2 != nullptr) {
+            event.frequencyHz = *reinterpret_cast<int*>(data);
+            event.text = *reinterpret_cast<std::string*>(data2);
+        }
+        break;
+    case ClientEventType::APIServerError:
+        if (data != nullptr) {
+            event.apiError
+                = *reinterpret_cast<afv_native::afv::APISessionError*>(data);
+        }
+        break;
+    case ClientEventType::VoiceServerError:
+    case ClientEventType::VoiceServerChannelError:
+        if (data != nullptr) {
+            event.errorCode = *reinterpret_cast<int*>(data);
+        }
+        break;
+    case ClientEventType::StationTransceiversUpdated:
+    case ClientEventType::AudioDeviceStoppedError:
+        if (data != nullptr) {
+            event.text = *reinterpret_cast<std::string*>(data);
+        }
+        break;
+    case ClientEventType::VccsReceived:
+        if (data != nullptr && data2 != nullptr) {
+            const auto& stations
+                = *reinterpret_cast<std::map<std::string, unsigned int>*>(
+                    data2);
+            event.stations.assign(stations.begin(), stations.end());
+        }
+        break;
+    case ClientEventType::StationDataReceived:
+        if (data != nullptr && data2 != nullptr) {
+            event.found = *reinterpret_cast<bool*>(data);
+            const auto& station
+                = *reinterpret_cast<std::pair<std::string, unsigned int>*>(
+                    data2);
+            event.text = station.first;
+            event.frequencyHz = static_cast<int>(station.second);
+        }
+        break;
+    default:
+        break;
+    }
+
+    return event;
+}
+
+bool ClientEventQueue::push(ClientEvent event)
+{
+    if (isHighRate(event.type)) {
+        event.sequence = pNextSequence.fetch_add(1);
+        return pHighRate.tryPush(std::move(event));
+    }
+
+    // Numbered under the lock so the list stays in sequence order
+    const std::lock_guard<std::mutex> l(pMutex);
+    event.sequence = pNextSequence.fetch_add(1);
+    pControl.push_back(std::move(event));
+    return true;
+}
+
+size_t ClientEventQueue::depth() const
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+    return pHighRate.depth() + pControl.size() + (pHoldingHead ? 1 : 0);
+}
+
+bool ClientEventQueue::isHighRate(afv_native::ClientEventType type)
+{
+    using afv_native::ClientEventType;
+
+    switch (type) {
+    case ClientEventType::PttOpen:
+    case ClientEventType::PttClosed:
+    case ClientEventType::RxOpen:
+    case ClientEventType::RxClosed:
+    case ClientEventType::PilotRxOpen:
+    case ClientEventType::PilotRxClosed:
+        return true;
+    default:
+        return false;
+    }
+}
+}
@@ -0,0 +1,193 @@
+#include "afv/radio_state_cache.h"
+
+#include <algorithm>
+
+namespace vector_audio::afv {
+
+namespace {
+    bool sameState(const RadioState& a, const RadioState& b)
+    {
+        return a.rx == b.rx && a.tx == b.tx && a.xc == b.xc
+            && a.onHeadset == b.onHeadset && a.active == b.active
+            && a.rxActive == b.rxActive && a.txActive == b.txActive
+            && a.lastReceivedCallsign == b.lastReceivedCallsign;
+    }
+}
+
+RadioStateCache::RadioStateCache(
+    std::shared_ptr<afv_native::api::atcClient> client,
+    ns::StationRegistry& stations)
+    : pClient(std::move(client))
+    , pStations(stations)
+{
+    pStationListener = pStations.subscribe(
+        [this](ns::StationRegistry::Change /*change*/,
+            const ns::Station& station) {
+            // Updates are new transceivers, which can change whether afv has
+            // the frequency active
+            this->invalidate(station.getFrequencyHz());
+        });
+}
+
+RadioStateCache::~RadioStateCache()
+{
+    pStations.unsubscribe(pStationListener);
+}
+
+void RadioStateCache::refresh()
+{
+    const auto now = std::chrono::steady_clock::now();
+    bool full = false;
+
+    pToRefresh.clear();
+    {
+        const std::unique_lock<std::shared_mutex> lock(pMutex);
+        full = pAllDirty || now - pLastFullRefresh >= kFullRefreshInterval;
+        if (!full) {
+            pToRefresh.assign(pDirty.begin(), pDirty.end());
+        }
+        pDirty.clear();
+        pAllDirty = false;
+    }
+
+    if (full) {
+        pLastFullRefresh = now;
+        pStations.forEach([&](auto /*handle*/, const ns::Station& station) {
+            pToRefresh.push_back(station.getFrequencyHz());
+        });
+        std::sort(pToRefresh.begin(), pToRefresh.end());
+    } else if (pToRefresh.empty()) {
+        return;
+    }
+
+    // Query without holding the lock, afv-native takes its own
+    pRefreshed.clear();
+    for (int frequency : pToRefresh) {
+        if (!full && !pStations.hasFrequency(frequency)) {
+            pRefreshed.emplace_back(frequency, std::nullopt);
+            continue;
+        }
+        pRefreshed.emplace_back(frequency, this->query(frequency));
+    }
+
+    bool changed = false;
+    const std::unique_lock<std::shared_mutex> lock(pMutex);
+    if (full) {
+        // Drop the stations that are gone
+        for (auto it = pStates.begin(); it != pStates.end();) {
+            if (std::binary_search(
+                    pToRefresh.begin(), pToRefresh.end(), it->first)) {
+                ++it;
+            } else {
+                it = pStates.erase(it);
+                changed = true;
+            }
+        }
+    }
+    for (auto& [frequency, state] : pRefreshed) {
+        if (!state) {
+            changed = pStates.erase(frequency) > 0 || changed;
+            continue;
+        }
+
+        auto& cached = pStates[frequency];
+        if (!sameState(cached, *state)) {
+            cached = std::move(*state);
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        pVersion++;
+    }
+}
+
+void RadioStateCache::invalidate(int frequencyHz)
+{
+    const std::unique_lock<std::shared_mutex> lock(pMutex);
+    pDirty.insert(frequencyHz);
+}
+
+void RadioStateCache::invalidateAll()
+{
+    const std::unique_lock<std::shared_mutex> lock(pMutex);
+    pAllDirty = true;
+}
+
+void RadioStateCache::handleEvent(const ClientEvent& event)
+{
+    using afv_native::ClientEventType;
+    const auto evt = event.type;
+
+    if (evt == ClientEventType::VoiceServerConnected
+        || evt == ClientEventType::VoiceServerDisconnected
+        || evt == ClientEventType::APIServerDisconnected) {
+        this->invalidateAll();
+        return;
+    }
+
+    if (evt == ClientEventType::PttOpen || evt == ClientEventType::PttClosed) {
+        this->setPtt(evt == ClientEventType::PttOpen);
+        return;
+    }
+
+    if (evt == ClientEventType::RxOpen || evt == ClientEventType::RxClosed) {
+        const std::unique_lock<std::shared_mutex> lock(pMutex);
+        auto it = pStates.find(event.frequencyHz);
+        if (it != pStates.end()) {
+            it->second.rxActive = evt == ClientEventType::RxOpen;
+            pVersion++;
+        }
+        return;
+    }
+
+    if (evt == ClientEventType::PilotRxOpen && !event.text.empty()) {
+        const std::unique_lock<std::shared_mutex> lock(pMutex);
+        auto it = pStates.find(event.frequencyHz);
+        if (it != pStates.end()) {
+            it->second.lastReceivedCallsign = event.text;
+            pVersion++;
+        }
+    }
+}
+
+void RadioStateCache::setPtt(bool open)
+{
+    const std::unique_lock<std::shared_mutex> lock(pMutex);
+    if (pPttOpen == open) {
+        return;
+    }
+
+    pPttOpen = open;
+    for (auto& [frequency, state] : pStates) {
+        state.txActive = open && state.tx;
+    }
+    pVersion++;
+}
+
+RadioState RadioStateCache::get(int frequencyHz) const
+{
+    const std::shared_lock<std::shared_mutex> lock(pMutex);
+    auto it = pStates.find(frequencyHz);
+    if (it == pStates.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+RadioState RadioStateCache::query(int frequencyHz) const
+{
+    const auto frequency = static_cast<unsigned int>(frequencyHz);
+
+    RadioState state;
+    state.rx = pClient->GetRxState(frequency);
+    state.tx = pClient->GetTxState(frequency);
+    state.xc = pClient->GetXcState(frequency);
+    state.onHeadset = pClient->GetOnHeadset(frequency);
+    state.active = pClient->IsFrequencyActive(frequency);
+    state.rxActive = pClient->GetRxActive(frequency);
+    state.txActive = pClient->GetTxActive(frequency);
+    state.lastReceivedCallsign = pClient->LastTransmitOnFreq(frequency);
+    return state;
+}
+}
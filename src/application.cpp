@@ -9,9 +9,17 @@
 namespace vector_audio::application {
 using util::TextURL;
 
-App::App()
-    : pDataHandler(std::make_unique<vatsim::DataHandler>())
+App::App(ui::FramePacer& framePacer)
+    : pDataHandler(std::make_unique<vatsim::DataHandler>(
+        vatsim::Endpoints::fromConfig(Configuration::mConfig)))
+    , pFramePacer(framePacer)
 {
+    // Stations can also be changed through the SDK
+    pStationListener = shared::stations.subscribe(
+        [this](ns::StationRegistry::Change, const ns::Station&) {
+            pFramePacer.wake();
+        });
+
     try {
         afv_native::api::setLogger(
             [this](auto&& subsystem, auto&& file, auto&& line, auto&& lineOut) {
@@ -35,7 +43,11 @@ App::App()
         return;
     }
 
-    pSDK = std::make_unique<SDK>(pClient);
+    pRadioState
+        = std::make_shared<afv::RadioStateCache>(pClient, shared::stations);
+    pSDK = std::make_unique<SDK>(pClient, pRadioState);
+    pPttMonitor = std::make_unique<native::PttMonitor>(
+        [this](bool pressed) { handlePttChange(pressed); });
 
     // Load all from config
     try {
@@ -109,15 +121,14 @@ App::App()
                 std::forward<decltype(data_two)>(data_two));
         });
 
-    // Start the API timer
-    shared::currentlyTransmittingApiTimer
-        = std::chrono::high_resolution_clock::now();
-
     // Start the SDK server
     auto _ = pSDK->start(); // Todo: display error if possible
 
     // Load the airport database async
-    std::thread(&application::App::loadAirportsDatabaseAsync).detach();
+    pAirportDatabase.loadAsync(Configuration::mAirportsIndexFilePath,
+        Configuration::mAirportsDBFilePath,
+        ns::CallsignResolver::aliasesFromConfig(Configuration::mConfig),
+        [this]() { pFramePacer.wake(); });
 
     auto soundPath = Configuration::get_resource_folder()
         / std::filesystem::path("disconnect.wav");
@@ -133,98 +144,111 @@ App::App()
 
 App::~App()
 {
+    shared::stations.unsubscribe(pStationListener);
+
+    // The connect sequence uses the client, so it must be done with it first
+    if (pConnectResult.valid()) {
+        pConnectResult.wait();
+    }
+
+    // Stops the PTT thread, which uses the client
+    pPttMonitor.reset();
     pSDK.reset();
     pClient.reset();
 }
 
-void App::loadAirportsDatabaseAsync()
+void App::handlePttChange(bool pressed)
 {
-    // if we cannot load this database, it's not that important, we will just
-    // log it.
-
-    if (!std::filesystem::exists(Configuration::mAirportsDBFilePath)) {
-        spdlog::warn("Could not find airport database json file");
+    // Transmitting needs a voice connection, releasing always goes through
+    if (pressed && !pClient->IsVoiceConnected()) {
+        return;
+    }
+    if (shared::isPttOpen.exchange(pressed) == pressed) {
         return;
     }
 
-    try {
-        // We do performance analysis here
-        auto t1 = std::chrono::high_resolution_clock::now();
-        std::ifstream f(Configuration::mAirportsDBFilePath);
-        nlohmann::json data = nlohmann::json::parse(f);
-
-        // Loop through all the icaos
-        for (const auto& obj : data.items()) {
-            ns::Airport ar;
-            obj.value().at("icao").get_to(ar.icao);
-            obj.value().at("elevation").get_to(ar.elevation);
-            obj.value().at("lat").get_to(ar.lat);
-            obj.value().at("lon").get_to(ar.lon);
-
-            // Assumption: The user will not have time to connect by the time
-            // this is loaded, hence should be fine re concurrency
-            ns::Airport::mAll.insert(std::make_pair(obj.key(), ar));
-        }
+    pClient->SetPtt(pressed);
+    pRadioState->setPtt(pressed);
+    pFramePacer.wake();
+}
 
-        auto t2 = std::chrono::high_resolution_clock::now();
-        spdlog::info("Loaded {} airports in {}", ns::Airport::mAll.size(),
-            std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1));
-    } catch (nlohmann::json::exception& ex) {
-        spdlog::warn("Could parse airport database: {}", ex.what());
-        return;
+native::PttBinding App::currentPttBinding() const
+{
+    native::PttBinding binding;
+    if (!pClient->IsVoiceConnected()) {
+        return binding;
+    }
+
+    binding.key = shared::ptt;
+    binding.fallbackKey = shared::fallbackPtt;
+    binding.joystickId = shared::joyStickId;
+    binding.joystickButton = shared::joyStickPtt;
+    if (binding.joystickId != -1) {
+        const auto id = sf::Joystick::getIdentification(
+            static_cast<unsigned int>(binding.joystickId));
+        binding.joystickName = id.name.toAnsiString();
+    }
+#ifdef _WIN32
+    if (binding.joystickId == -1) {
+        binding.virtualKey
+            = native::win32::get_virtual_key(binding.key, binding.fallbackKey);
     }
+#endif
+    return binding;
 }
 
 void App::eventCallback(
     afv_native::ClientEventType evt, void* data, void* data2)
 {
+    // Runs on the afv-native thread, which must never wait on the UI or on
+    // the SDK: copy the payload out, queue it and return
+    auto event = afv::ClientEvent::fromCallback(evt, data, data2);
+    if (SDK::wantsClientEvent(evt)) {
+        pSDK->queueClientEvent(event);
+    }
+    pClientEvents.push(std::move(event));
+    pFramePacer.wake();
+}
+
+void App::drainClientEvents()
+{
+    pClientEvents.drain(
+        [this](const afv::ClientEvent& event) { handleClientEvent(event); });
+
+    const auto overflows = pClientEvents.overflows();
+    if (overflows != pReportedEventOverflows) {
+        spdlog::warn("UI dropped {} afv RX and PTT events, its queue was full",
+            overflows - pReportedEventOverflows);
+        pReportedEventOverflows = overflows;
+    }
+}
+
+void App::handleClientEvent(const afv::ClientEvent& event)
+{
+    const auto evt = event.type;
+
     if (evt == afv_native::ClientEventType::VccsReceived) {
-        if (data != nullptr && data2 != nullptr) {
-            // We got new VCCS stations, we can add them to our list and start
-            // getting their transceivers
-            std::map<std::string, unsigned int> stations
-                = *reinterpret_cast<std::map<std::string, unsigned int>*>(
-                    data2);
-
-            if (pClient->IsVoiceConnected()) {
-                for (auto s : stations) {
-                    s.second = util::cleanUpFrequency(s.second);
-                    ns::Station el = ns::Station::build(s.first, s.second);
-
-                    {
-                        std::lock_guard<std::mutex> lock(
-                            shared::fetchedStationMutex);
-                        if (!frequencyExists(el.getFrequencyHz()))
-                            shared::fetchedStations.push_back(el);
-                    }
-                }
+        // We got new VCCS stations, we can add them to our list and start
+        // getting their transceivers
+        if (pClient->IsVoiceConnected()) {
+            for (auto s : event.stations) {
+                s.second = util::cleanUpFrequency(s.second);
+                shared::stations.add(ns::Station::build(s.first, s.second));
             }
         }
     }
 
     if (evt == afv_native::ClientEventType::StationTransceiversUpdated) {
-        if (data != nullptr) {
+        if (!event.text.empty()) {
             // We just refresh the transceiver count in our display
-            std::lock_guard<std::mutex> lock(shared::fetchedStationMutex);
-            std::string station = *reinterpret_cast<std::string*>(data);
-            auto it = std::find_if(shared::fetchedStations.begin(),
-                shared::fetchedStations.end(), [station](const auto& fs) {
-                    return fs.getCallsign() == station;
-                });
-            if (it != shared::fetchedStations.end())
-                it->setTransceiverCount(
-                    pClient->GetTransceiverCountForStation(station));
+            shared::stations.setTransceiverCount(event.text,
+                pClient->GetTransceiverCountForStation(event.text));
         }
     }
 
     if (evt == afv_native::ClientEventType::APIServerError) {
         // We got an error from the API server, we can display this to the user
-        if (data == nullptr) {
-            return;
-        }
-
-        afv_native::afv::APISessionError err
-            = *reinterpret_cast<afv_native::afv::APISessionError*>(data);
+        const auto err = event.apiError;
 
         if (err == afv_native::afv::APISessionError::BadPassword
             || err == afv_native::afv::APISessionError::RejectedCredentials) {
@@ -304,76 +328,37 @@ void App::eventCallback(
     }
 
     if (evt == afv_native::ClientEventType::VoiceServerError) {
-        int errCode = *reinterpret_cast<int*>(data);
-        errorModal("Voice server returned error " + std::to_string(errCode)
+        errorModal("Voice server returned error "
+            + std::to_string(event.errorCode)
             + ", please check the log file.");
         disconnectAndCleanup();
         playErrorSound();
     }
 
     if (evt == afv_native::ClientEventType::VoiceServerChannelError) {
-        int errCode = *reinterpret_cast<int*>(data);
         errorModal("Voice server returned channel error "
-            + std::to_string(errCode) + ", please check the log file.");
+            + std::to_string(event.errorCode)
+            + ", please check the log file.");
         disconnectAndCleanup();
         playErrorSound();
     }
 
     if (evt == afv_native::ClientEventType::AudioDeviceStoppedError) {
-        errorModal("The audio device " + *reinterpret_cast<std::string*>(data)
+        errorModal("The audio device " + event.text
             + " has stopped working"
               ", check if it is still physically connected.");
         disconnectAndCleanup();
         playErrorSound();
     }
 
-    if (evt == afv_native::ClientEventType::PilotRxOpen) {
-        // Bug in that this applies to RX to all station types, including ATC,
-        // not only pilots
-        if (data != nullptr && data2 != nullptr) {
-            int frequency = *reinterpret_cast<int*>(data);
-            std::string callsign = *reinterpret_cast<std::string*>(data2);
-            spdlog::debug("Pilot {} opened RX", callsign);
-            pSDK->handleAFVEventForWebsocket(
-                sdk::types::Event::kRxBegin, callsign, frequency);
-        }
-    }
-
-    if (evt == afv_native::ClientEventType::PilotRxClosed) {
-        if (data != nullptr && data2 != nullptr) {
-            int frequency = *reinterpret_cast<int*>(data);
-            std::string callsign = *reinterpret_cast<std::string*>(data2);
-            spdlog::debug("Pilot {} closed RX", callsign);
-            pSDK->handleAFVEventForWebsocket(
-                sdk::types::Event::kRxEnd, callsign, frequency);
-        }
-    }
-
     if (evt == afv_native::ClientEventType::StationDataReceived) {
-        if (data != nullptr && data2 != nullptr) {
-            // We just refresh the transceiver count in our display
-            bool found = *reinterpret_cast<bool*>(data);
-            if (found) {
-                auto station
-                    = *reinterpret_cast<std::pair<std::string, unsigned int>*>(
-                        data2);
-
-                station.second = util::cleanUpFrequency(station.second);
-
-                ns::Station el
-                    = ns::Station::build(station.first, station.second);
-
-                {
-                    std::lock_guard<std::mutex> lock(
-                        shared::fetchedStationMutex);
-                    if (!frequencyExists(el.getFrequencyHz()))
-                        shared::fetchedStations.push_back(el);
-                }
-            } else {
-                errorModal("Could not find station in database.");
-                spdlog::warn(
-                    "Station not found in AFV database through search");
-            }
+        if (event.found) {
+            shared::stations.add(ns::Station::build(event.text,
+                util::cleanUpFrequency(
+                    static_cast<unsigned int>(event.frequencyHz))));
+        } else {
+            errorModal("Could not find station in database.");
+            spdlog::warn("Station not found in AFV database through search");
         }
     }
 }
@@ -381,87 +366,59 @@ void App::eventCallback(
 // Main loop
 void App::render_frame()
 {
+    drainClientEvents();
+    handlePilotLookupResult();
+    handleConnectResult();
+
+    pDataHandler->setWindowFocused(shared::isWindowFocused);
+
+    // One consistent view of the session for the whole frame
+    const auto session = shared::session::get();
+
     // AFV stuff
     if (pClient) {
         shared::mPeak = static_cast<float>(pClient->GetInputPeak());
         shared::mVu = static_cast<float>(pClient->GetInputVu());
 
-        // Set the Ptt if required, input based on event
-        if (pClient->IsVoiceConnected()
-            && (shared::ptt != sf::Keyboard::Scan::Unknown
-                || shared::joyStickId != -1)) {
-            if (shared::isPttOpen) {
-                if (shared::joyStickId != -1) {
-                    if (!sf::Joystick::isButtonPressed(
-                            shared::joyStickId, shared::joyStickPtt)) {
-                        shared::isPttOpen = false;
-                    }
-                } else {
-                    if (shared::fallbackPtt != sf::Keyboard::Unknown) {
-                        if (!sf::Keyboard::isKeyPressed(shared::fallbackPtt)) {
-                            shared::isPttOpen = false;
-                        }
-                    } else if (!sf::Keyboard::isKeyPressed(shared::ptt)) {
-                        shared::isPttOpen = false;
-                    }
-                }
-
-                pClient->SetPtt(shared::isPttOpen);
-            } else {
-                if (shared::joyStickId != -1) {
-                    if (sf::Joystick::isButtonPressed(
-                            shared::joyStickId, shared::joyStickPtt)) {
-                        shared::isPttOpen = true;
-                    }
-                } else {
-                    if (shared::fallbackPtt != sf::Keyboard::Unknown) {
-                        if (sf::Keyboard::isKeyPressed(shared::fallbackPtt)) {
-                            shared::isPttOpen = true;
-                        }
-                    } else if (sf::Keyboard::isKeyPressed(shared::ptt)) {
-                        shared::isPttOpen = true;
-                    }
-                }
-
-                pClient->SetPtt(shared::isPttOpen);
-            }
+        // The PTT itself is read by its own thread, unless SFML is the only
+        // way to read it
+        const auto pttBinding = currentPttBinding();
+        pPttMonitor->setBinding(pttBinding);
+        if (pPttMonitor->sampledOnMainThread()) {
+            pPttMonitor->reportSample(
+                native::PttMonitor::sampleWithSfml(pttBinding));
         }
 
-        {
-            std::lock_guard<std::mutex> lock(shared::fetchedStationMutex);
-
-            if (pClient->IsAPIConnected() && shared::fetchedStations.empty()
-                && !shared::bootUpVccs) {
-                // We force add the current user frequency
-                shared::bootUpVccs = true;
-
-                // We replaced double _ which may be used during frequency
-                // handovers, but are not defined in database
-                std::string cleanCallsign
-                    = util::ReplaceString(shared::session::callsign, "__", "_");
-
-                ns::Station el = ns::Station::build(
-                    cleanCallsign, shared::session::frequency);
-                if (!frequencyExists(el.getFrequencyHz()))
-                    shared::fetchedStations.push_back(el);
-
-                this->pClient->AddFrequency(
-                    shared::session::frequency, cleanCallsign);
-                pClient->SetEnableInputFilters(shared::mInputFilter);
-                pClient->SetEnableOutputEffects(shared::mOutputEffects);
-                this->pClient->UseTransceiversFromStation(
-                    cleanCallsign, shared::session::frequency);
-                this->pClient->SetRx(shared::session::frequency, true);
-                if (shared::session::facility > 0) {
-                    this->pClient->SetTx(shared::session::frequency, true);
-                    this->pClient->SetXc(shared::session::frequency, true);
-                }
-                this->pSDK->handleAFVEventForWebsocket(
-                    sdk::types::Event::kFrequencyStateUpdate, std::nullopt,
-                    std::nullopt);
-                this->pClient->FetchStationVccs(cleanCallsign);
-                this->pClient->SetRadioGainAll(shared::radioGain / 100.0F);
+        if (pClient->IsAPIConnected() && shared::stations.empty()
+            && !shared::bootUpVccs) {
+            // We force add the current user frequency
+            shared::bootUpVccs = true;
+
+            // We replaced double _ which may be used during frequency
+            // handovers, but are not defined in database
+            std::string cleanCallsign
+                = util::ReplaceString(session->callsign, "__", "_");
+
+            shared::stations.add(
+                ns::Station::build(cleanCallsign, session->frequency));
+
+            this->pClient->AddFrequency(session->frequency, cleanCallsign);
+            pClient->SetEnableInputFilters(shared::mInputFilter);
+            pClient->SetEnableOutputEffects(shared::mOutputEffects);
+            this->pClient->UseTransceiversFromStation(
+                cleanCallsign, session->frequency);
+            this->pClient->SetRx(session->frequency, true);
+            if (session->facility > 0) {
+                this->pClient->SetTx(session->frequency, true);
+                this->pClient->SetXc(session->frequency, true);
             }
+            pRadioState->invalidate(session->frequency);
+            pRadioState->refresh();
+            this->pSDK->handleAFVEventForWebsocket(
+                sdk::types::Event::kFrequencyStateUpdate, std::nullopt,
+                std::nullopt);
+            this->pClient->FetchStationVccs(cleanCallsign);
+            this->pClient->SetRadioGainAll(shared::radioGain / 100.0F);
         }
     }
 
@@ -478,7 +435,7 @@ void App::render_frame()
 
     // Callsign Field
     ImGui::PushItemWidth(100.0F);
-    std::string paddedCallsign = shared::session::callsign;
+    std::string paddedCallsign = session->callsign;
     std::string notConnected = "Not connected";
     if (paddedCallsign.length() < notConnected.length()) {
         paddedCallsign.insert(paddedCallsign.end(),
@@ -494,97 +451,20 @@ void App::render_frame()
 
     // Connect button logic
 
-    if (!pClient->IsVoiceConnected() && !pClient->IsAPIConnected()) {
-        bool readyToConnect = (!shared::session::isConnected
-                                  && pDataHandler->isSlurperAvailable())
-            || shared::session::isConnected;
+    const bool isConnecting = pConnectStage != ConnectStage::kIdle;
+    if (isConnecting
+        || (!pClient->IsVoiceConnected() && !pClient->IsAPIConnected())) {
+        bool readyToConnect = !isConnecting
+            && ((!session->isConnected
+                    && pDataHandler->isSlurperAvailable())
+                || session->isConnected);
         style::push_disabled_on(!readyToConnect);
 
-        if (ImGui::Button("Connect")) {
-
-            if (!shared::session::isConnected
-                && pDataHandler->isSlurperAvailable()) {
-                // We manually call the slurper here in case that we do not have
-                // a connection yet Although this will block the whole program,
-                // it is not an issue in this case As the user does not need to
-                // interact with the software while we attempt A connection that
-                // fails once will not be retried and will default to datafile
-                // only
-
-                shared::session::isConnected
-                    = pDataHandler->getConnectionStatusWithSlurper();
-            }
-
-            if (shared::session::isConnected) {
-                if (pClient->IsAudioRunning()) {
-                    pClient->StopAudio();
-                }
-                if (pClient->IsAPIConnected()) {
-                    pClient->Disconnect(); // Force a disconnect of API
-                }
-
-                pClient->SetAudioApi(findAudioAPIorDefault());
-                pClient->SetAudioInputDevice(findHeadsetInputDeviceOrDefault());
-                pClient->SetAudioOutputDevice(
-                    findHeadsetOutputDeviceOrDefault());
-                pClient->SetAudioSpeakersOutputDevice(
-                    findSpeakerOutputDeviceOrDefault());
-                pClient->SetHardware(shared::hardware);
-                pClient->SetPlaybackChannelAll(
-                    util::OutputChannelToAfvPlaybackChannel(
-                        shared::headsetOutputChannel));
-
-                if (!pDataHandler->isSlurperAvailable()) {
-                    std::string clientIcao = shared::session::callsign.substr(
-                        0, shared::session::callsign.find('_'));
-                    // We use the airport database for this
-                    if (ns::Airport::mAll.find(clientIcao)
-                        != ns::Airport::mAll.end()) {
-                        auto clientAirport = ns::Airport::mAll.at(clientIcao);
-
-                        // We pad the elevation by 10 meters to simulate the
-                        // client being in a tower
-                        pClient->SetClientPosition(clientAirport.lat,
-                            clientAirport.lon,
-                            clientAirport.elevation
-                                + shared::airportTransceiverElevationOffset,
-                            clientAirport.elevation
-                                + shared::airportTransceiverElevationOffset);
-
-                        spdlog::info("Found client position in database at "
-                                     "lat:{}, lon:{}, elev:{}",
-                            clientAirport.lat, clientAirport.lon,
-                            clientAirport.elevation);
-                    } else {
-                        spdlog::warn(
-                            "Client position is unknown, setting default.");
-
-                        // Default position is over Paris somewhere
-                        pClient->SetClientPosition(48.967860, 2.442000,
-                            shared::defaultTransceiverPositionElevation,
-                            shared::defaultTransceiverPositionElevation);
-                    }
-                } else {
-                    spdlog::info(
-                        "Found client position from slurper at lat:{}, lon:{}",
-                        shared::session::latitude, shared::session::longitude);
-                    pClient->SetClientPosition(shared::session::latitude,
-                        shared::session::longitude,
-                        shared::defaultTransceiverPositionElevation,
-                        shared::defaultTransceiverPositionElevation);
-                }
-
-                pClient->SetCredentials(
-                    std::to_string(shared::vatsimCid), shared::vatsimPassword);
-                pClient->SetCallsign(shared::session::callsign);
-                pClient->SetRadioGainAll(shared::radioGain / 100.0F);
-                if (!pClient->Connect()) {
-                    spdlog::error(
-                        "Failed to connect: afv_lib says API is connected.");
-                };
-            } else {
-                errorModal("Not connected to VATSIM!");
-            }
+        // The label changes while connecting, but the ID must not
+        std::string connectLabel
+            = std::string(connectStageLabel(pConnectStage)) + "###Connect";
+        if (ImGui::Button(connectLabel.c_str()) && readyToConnect) {
+            startConnect();
         }
         style::pop_disabled_on(!readyToConnect);
     } else {
@@ -597,7 +477,7 @@ void App::render_frame()
 
         // Auto disconnect if we need
         auto pressedDisconnect = ImGui::Button("Disconnect");
-        if (pressedDisconnect || !shared::session::isConnected) {
+        if (pressedDisconnect || !session->isConnected) {
 
             if (pressedDisconnect) {
                 pManuallyDisconnected = true;
@@ -611,8 +491,9 @@ void App::render_frame()
     ImGui::SameLine();
 
     // Settings modal
-    style::push_disabled_on(pClient->IsAPIConnected());
-    if (ImGui::Button("Settings") && !pClient->IsAPIConnected()) {
+    const bool settingsLocked = pClient->IsAPIConnected() || isConnecting;
+    style::push_disabled_on(settingsLocked);
+    if (ImGui::Button("Settings") && !settingsLocked) {
         // Update all available data
         shared::availableAudioAPI = pClient->GetAudioApis();
         shared::availableInputDevices
@@ -621,7 +502,7 @@ void App::render_frame()
             = pClient->GetAudioOutputDevices(shared::mAudioApi);
         ImGui::OpenPopup("Settings Panel");
     }
-    style::pop_disabled_on(pClient->IsAPIConnected());
+    style::pop_disabled_on(settingsLocked);
 
     ui::modals::Settings::render(pClient, [&]() -> void { playErrorSound(); });
 
@@ -644,7 +525,20 @@ void App::render_frame()
 
     ui::widgets::NetworkStatusWidget::Draw(pClient->IsVoiceConnected(),
         pDataHandler->isSlurperAvailable(),
-        pDataHandler->isDatafileAvailable());
+        pDataHandler->isDatafileAvailable(),
+        pDataHandler->getSlurperLatency(),
+        pDataHandler->getMirrorHealth(),
+        std::chrono::duration_cast<std::chrono::seconds>(
+            pDataHandler->getPollInterval()),
+        std::chrono::duration_cast<std::chrono::seconds>(
+            pDataHandler->getNextPollAt()
+            - std::chrono::steady_clock::now()));
+
+    if (pAirportDatabase.isLoading()) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("| Loading airports %.0f%%",
+            pAirportDatabase.getProgress() * 100.0F);
+    }
     ImGui::NewLine();
 
     //
@@ -655,12 +549,18 @@ void App::render_frame()
     ImGuiTableFlags flags = ImGuiTableFlags_BordersOuter
         | ImGuiTableFlags_BordersV | ImGuiTableFlags_NoBordersInBody
         | ImGuiTableFlags_ScrollY;
+    pRadioState->refresh();
     if (ImGui::BeginTable("stations_table", 3, flags,
             ImVec2(ImGui::GetContentRegionAvail().x * 0.8F, 0.0F))) {
         int counter = -1;
 
-        std::lock_guard<std::mutex> lock(shared::fetchedStationMutex);
-        for (auto& el : shared::fetchedStations) {
+        // The registry is read locked while drawing, so changes are applied
+        // once the loop is over
+        std::optional<ns::StationRegistry::Handle> pendingRemoval;
+        bool frequencyStateChanged = false;
+
+        shared::stations.forEach([&](ns::StationRegistry::Handle handle,
+                                     const ns::Station& el) {
             if (counter == -1 || counter == 4) {
                 counter = 1;
                 ImGui::TableNextRow();
@@ -677,16 +577,16 @@ void App::render_frame()
             ImGui::PushStyleVar(ImGuiStyleVar_FrameBorderSize, 1.F);
             ImGui::PushStyleColor(ImGuiCol_Button, ImColor(14, 17, 22).Value);
 
-            // Polling all data
+            // Polling all data, from the cache refreshed above
 
-            bool rxState = pClient->GetRxState(el.getFrequencyHz());
-            bool rxActive = pClient->GetRxActive(el.getFrequencyHz());
-            bool txState = pClient->GetTxState(el.getFrequencyHz());
-            bool txActive = pClient->GetTxActive(el.getFrequencyHz());
-            bool xcState = pClient->GetXcState(el.getFrequencyHz());
-            bool isOnSpeaker = !pClient->GetOnHeadset(el.getFrequencyHz());
-            bool freqActive = pClient->IsFrequencyActive(el.getFrequencyHz())
-                && (rxState || txState || xcState);
+            const auto radio = pRadioState->get(el.getFrequencyHz());
+            bool rxState = radio.rx;
+            bool rxActive = radio.rxActive;
+            bool txState = radio.tx;
+            bool txActive = radio.txActive;
+            bool xcState = radio.xc;
+            bool isOnSpeaker = !radio.onHeadset;
+            bool freqActive = radio.active && (rxState || txState || xcState);
 
             //
             // Frequency button
@@ -724,19 +624,7 @@ void App::render_frame()
                                           .append(el.getCallsign())
                                           .c_str())) {
                     pClient->RemoveFrequency(el.getFrequencyHz());
-
-                    shared::fetchedStations.erase(
-                        std::remove_if(shared::fetchedStations.begin(),
-                            shared::fetchedStations.end(),
-                            [el](ns::Station const& p) {
-                                return el.getFrequencyHz()
-                                    == p.getFrequencyHz();
-                            }),
-                        shared::fetchedStations.end());
-
-                    this->pSDK->handleAFVEventForWebsocket(
-                        sdk::types::Event::kFrequencyStateUpdate, std::nullopt,
-                        std::nullopt);
+                    pendingRemoval = handle;
                 }
                 ImGui::EndPopup();
             }
@@ -751,8 +639,7 @@ void App::render_frame()
                 // Set button colour
                 rxActive ? style::button_yellow() : style::button_green();
 
-                auto receivedCld
-                    = pClient->LastTransmitOnFreq(el.getFrequencyHz());
+                const auto& receivedCld = radio.lastReceivedCallsign;
                 if (!receivedCld.empty()
                     && std::find(receivedCallsigns.begin(),
                            receivedCallsigns.end(), receivedCld)
@@ -785,9 +672,8 @@ void App::render_frame()
                     pClient->SetRx(el.getFrequencyHz(), true);
                     pClient->SetRadioGainAll(shared::radioGain / 100.0F);
                 }
-                this->pSDK->handleAFVEventForWebsocket(
-                    sdk::types::Event::kFrequencyStateUpdate, std::nullopt,
-                    std::nullopt);
+                pRadioState->invalidate(el.getFrequencyHz());
+                frequencyStateChanged = true;
             }
 
             if (rxState)
@@ -807,7 +693,7 @@ void App::render_frame()
             if (ImGui::Button(
                     std::string("XC##").append(el.getCallsign()).c_str(),
                     quarterSize)
-                && shared::session::facility > 0) {
+                && session->facility > 0) {
                 if (freqActive) {
                     pClient->SetXc(el.getFrequencyHz(), !xcState);
                 } else {
@@ -823,9 +709,8 @@ void App::render_frame()
                     pClient->SetRadioGainAll(shared::radioGain / 100.0F);
                 }
 
-                this->pSDK->handleAFVEventForWebsocket(
-                    sdk::types::Event::kFrequencyStateUpdate, std::nullopt,
-                    std::nullopt);
+                pRadioState->invalidate(el.getFrequencyHz());
+                frequencyStateChanged = true;
             }
 
             if (xcState)
@@ -850,8 +735,10 @@ void App::render_frame()
             speakerString.append("\nSPK##");
             speakerString.append(el.getCallsign());
             if (ImGui::Button(speakerString.c_str(), quarterSize)) {
-                if (freqActive)
+                if (freqActive) {
                     pClient->SetOnHeadset(el.getFrequencyHz(), isOnSpeaker);
+                    pRadioState->invalidate(el.getFrequencyHz());
+                }
             }
 
             if (isOnSpeaker)
@@ -869,7 +756,7 @@ void App::render_frame()
             if (ImGui::Button(
                     std::string("TX##").append(el.getCallsign()).c_str(),
                     halfSize)
-                && shared::session::facility > 0) {
+                && session->facility > 0) {
                 if (freqActive) {
                     pClient->SetTx(el.getFrequencyHz(), !txState);
                 } else {
@@ -883,9 +770,8 @@ void App::render_frame()
                     pClient->SetRx(el.getFrequencyHz(), true);
                     pClient->SetRadioGainAll(shared::radioGain / 100.0F);
                 }
-                this->pSDK->handleAFVEventForWebsocket(
-                    sdk::types::Event::kFrequencyStateUpdate, std::nullopt,
-                    std::nullopt);
+                pRadioState->invalidate(el.getFrequencyHz());
+                frequencyStateChanged = true;
             }
 
             if (txState)
@@ -895,6 +781,17 @@ void App::render_frame()
             ImGui::PopStyleVar(2);
 
             counter++;
+        });
+
+        // Removals are broadcast by the SDK as they happen
+        if (pendingRemoval) {
+            shared::stations.remove(*pendingRemoval);
+        }
+        if (frequencyStateChanged) {
+            pRadioState->refresh();
+            this->pSDK->handleAFVEventForWebsocket(
+                sdk::types::Event::kFrequencyStateUpdate, std::nullopt,
+                std::nullopt);
         }
 
         ImGui::EndTable();
@@ -910,9 +807,12 @@ void App::render_frame()
     ImGui::BeginGroup();
 
     ui::widgets::AddStationWidget::Draw(
-        pClient->IsVoiceConnected(), [&](std::string stationCallsign) -> void {
+        pClient->IsVoiceConnected(),
+        pPilotLookup ? pPilotLookup->callsign : std::string(),
+        [&](std::string stationCallsign) -> void {
             addNewStation(std::move(stationCallsign));
-        });
+        },
+        [&]() -> void { cancelPilotLookup(); });
     ImGui::NewLine();
 
     ui::widgets::GainWidget::Draw(pClient->IsVoiceConnected(),
@@ -928,6 +828,29 @@ void App::render_frame()
 
     // Version
     ImGui::TextUnformatted(VECTOR_VERSION);
+    if (ImGui::IsItemHovered()) {
+        const auto& frameStats = pFramePacer.getStats();
+        ImGui::BeginTooltip();
+        ImGui::Text("Frame: %.1fms CPU, %.1fms GPU, %.0f fps%s",
+            frameStats.cpuMs, frameStats.gpuMs, frameStats.framesPerSecond,
+            frameStats.idle ? " (idle)" : "");
+        ui::widgets::PttLatencyWidget::Draw(
+            pPttMonitor->getLatency(), pPttMonitor->getBackendName());
+        const auto drawQueue
+            = [](const char* name, const afv::ClientEventQueue& queue) {
+                  ImGui::Text("%s events: %zu queued, %zu max, %llu dropped",
+                      name, queue.depth(), queue.highWater(),
+                      static_cast<unsigned long long>(queue.overflows()));
+              };
+        drawQueue("UI", pClientEvents);
+        drawQueue("SDK", pSDK->getEventQueue());
+        const auto websockets = pSDK->getWebsocketStats();
+        ImGui::Text("Websocket: %zu clients, %llu dropped, %llu evicted",
+            websockets.clients,
+            static_cast<unsigned long long>(websockets.dropped),
+            static_cast<unsigned long long>(websockets.evicted));
+        ImGui::EndTooltip();
+    }
 
     // Licenses
 
@@ -941,7 +864,19 @@ void App::render_frame()
         pShowErrorModal = false;
     }
 
-    SDK::loopCleanup(liveReceivedCallsigns);
+    pSDK->publishTransmitting(liveReceivedCallsigns);
+
+    // A PTT sampled here is only as recent as the last frame, the VU meter,
+    // the connect stage and background work in progress change without any
+    // event
+    const bool pttSampled
+        = pClient->IsVoiceConnected() && pPttMonitor->sampledOnMainThread();
+    const bool vuMeterActive
+        = ImGui::IsPopupOpen("Settings Panel") && pClient->IsAudioRunning();
+    const bool backgroundWork
+        = pPilotLookup.has_value() || pAirportDatabase.isLoading();
+    pWantsContinuousFrames = pttSampled || vuMeterActive || backgroundWork
+        || pConnectStage != ConnectStage::kIdle;
 
     ImGui::End();
 }
@@ -952,15 +887,6 @@ void App::errorModal(std::string message)
     this->pLastErrorModalMessage = std::move(message);
 }
 
-bool App::frequencyExists(int freq)
-{
-    return std::find_if(shared::fetchedStations.begin(),
-               shared::fetchedStations.end(),
-               [&freq](
-                   const auto& obj) { return obj.getFrequencyHz() == freq; })
-        != shared::fetchedStations.end();
-}
-
 void App::disconnectAndCleanup()
 {
     if (!pClient) {
@@ -970,11 +896,11 @@ void App::disconnectAndCleanup()
     pClient->Disconnect();
     pClient->StopAudio();
 
-    std::lock_guard<std::mutex> lock(shared::fetchedStationMutex);
-    for (const auto& f : shared::fetchedStations)
+    cancelPilotLookup();
+
+    for (const auto& f : shared::stations.clear())
         pClient->RemoveFrequency(f.getFrequencyHz());
 
-    shared::fetchedStations.clear();
     shared::bootUpVccs = false;
 }
 
@@ -994,38 +920,33 @@ void App::addNewStation(std::string stationCallsign)
         pClient->GetStation(stationCallsign);
         pClient->FetchStationVccs(stationCallsign);
     } else if (absl::StartsWith(stationCallsign, "!")) {
-        double latitude = 0.0;
-        double longitude = 0.0;
         stationCallsign = stationCallsign.substr(1);
 
-        std::lock_guard<std::mutex> lock(shared::fetchedStationMutex);
-
-        if (!frequencyExists(shared::kUnicomFrequency)) {
-            if (pDataHandler->getPilotPositionWithAnything(
-                    stationCallsign, latitude, longitude)) {
-
-                ns::Station el = ns::Station::build(
-                    stationCallsign, shared::kUnicomFrequency);
-
-                if (!frequencyExists(el.getFrequencyHz()))
-                    shared::fetchedStations.push_back(el);
-
-                pClient->SetClientPosition(latitude, longitude,
-                    shared::defaultSUPTransceiverPositionElevation,
-                    shared::defaultSUPTransceiverPositionElevation);
-                pClient->AddFrequency(
-                    shared::kUnicomFrequency, stationCallsign);
-                pClient->SetRx(shared::kUnicomFrequency, true);
-                pClient->SetRadioGainAll(shared::radioGain / 100.0F);
-
-            } else {
-                errorModal("Could not find pilot connected under that "
-                           "callsign.");
-            }
-        } else {
+        if (shared::stations.hasFrequency(shared::kUnicomFrequency)) {
             errorModal("Another UNICOM frequency is active, please "
                        "delete it first.");
+            return;
         }
+
+        cancelPilotLookup();
+
+        // The lookup may go to the network, so it runs in the background
+        // without holding any lock, and is picked up by render_frame
+        pPilotLookup = PilotLookup { stationCallsign,
+            std::async(std::launch::async,
+                [dataHandler = pDataHandler.get(), pacer = &pFramePacer,
+                    stationCallsign]() -> PilotPosition {
+                    double latitude = 0.0;
+                    double longitude = 0.0;
+                    const bool found
+                        = dataHandler->getPilotPositionWithAnything(
+                            stationCallsign, latitude, longitude);
+                    pacer->wake();
+                    if (!found) {
+                        return std::nullopt;
+                    }
+                    return std::make_pair(latitude, longitude);
+                }) };
     } else {
         double latitude = 0.0;
         double longitude = 0.0;
@@ -1038,14 +959,9 @@ void App::addNewStation(std::string stationCallsign)
             errorModal("Failed to parse frequency, format is #123456");
         }
 
-        std::lock_guard<std::mutex> lock(shared::fetchedStationMutex);
-
-        if (!frequencyExists(frequency) && frequency != 0) {
-            ns::Station el = ns::Station::build(stationCallsign, frequency);
-
-            if (!frequencyExists(el.getFrequencyHz()))
-                shared::fetchedStations.push_back(el);
-
+        if (frequency != 0
+            && shared::stations.add(
+                ns::Station::build(stationCallsign, frequency))) {
             pClient->SetClientPosition(latitude, longitude,
                 shared::defaultSUPTransceiverPositionElevation,
                 shared::defaultSUPTransceiverPositionElevation);
@@ -1058,4 +974,235 @@ void App::addNewStation(std::string stationCallsign)
         }
     }
 }
-} // namespace application
\ No newline at end of file
+
+void App::handlePilotLookupResult()
+{
+    pCancelledPilotLookups.erase(
+        std::remove_if(pCancelledPilotLookups.begin(),
+            pCancelledPilotLookups.end(),
+            [](const auto& lookup) {
+                return lookup.wait_for(std::chrono::seconds(0))
+                    == std::future_status::ready;
+            }),
+        pCancelledPilotLookups.end());
+
+    if (!pPilotLookup
+        || pPilotLookup->result.wait_for(std::chrono::seconds(0))
+            != std::future_status::ready) {
+        return;
+    }
+
+    auto lookup = std::move(*pPilotLookup);
+    pPilotLookup.reset();
+
+    PilotPosition position;
+    try {
+        position = lookup.result.get();
+    } catch (const std::exception& ex) {
+        spdlog::error("Pilot position lookup failed: {}", ex.what());
+    }
+
+    if (!position) {
+        errorModal("Could not find pilot connected under that callsign.");
+        return;
+    }
+
+    if (!pClient->IsVoiceConnected()) {
+        return;
+    }
+
+    if (!shared::stations.add(
+            ns::Station::build(lookup.callsign, shared::kUnicomFrequency))) {
+        errorModal("Another UNICOM frequency is active, please "
+                   "delete it first.");
+        return;
+    }
+
+    pClient->SetClientPosition(position->first, position->second,
+        shared::defaultSUPTransceiverPositionElevation,
+        shared::defaultSUPTransceiverPositionElevation);
+    pClient->AddFrequency(shared::kUnicomFrequency, lookup.callsign);
+    pClient->SetRx(shared::kUnicomFrequency, true);
+    pClient->SetRadioGainAll(shared::radioGain / 100.0F);
+}
+
+void App::cancelPilotLookup()
+{
+    if (!pPilotLookup) {
+        return;
+    }
+
+    // The request itself cannot be interrupted, so we keep the future around
+    // until it completes rather than blocking on its destructor
+    spdlog::debug("Cancelled pilot lookup for {}", pPilotLookup->callsign);
+    pCancelledPilotLookups.push_back(std::move(pPilotLookup->result));
+    pPilotLookup.reset();
+}
+
+void App::startConnect()
+{
+    if (pConnectStage != ConnectStage::kIdle) {
+        return;
+    }
+
+    pConnectStage = ConnectStage::kCheckingSession;
+    pDataHandler->requestFastPolling();
+    pConnectResult = std::async(
+        std::launch::async, [this]() { return runConnectSequence(); });
+}
+
+std::optional<std::string> App::runConnectSequence()
+{
+    auto stageStart = std::chrono::steady_clock::now();
+    auto nextStage = [&](ConnectStage next) {
+        auto now = std::chrono::steady_clock::now();
+        spdlog::info("Connect stage '{}' took {}ms",
+            connectStageLabel(pConnectStage),
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                now - stageStart)
+                .count());
+        stageStart = now;
+        pConnectStage = next;
+    };
+
+    if (!shared::session::get()->isConnected
+        && pDataHandler->isSlurperAvailable()) {
+        // We manually call the slurper here in case that we do not have a
+        // connection yet. A connection that fails once will not be retried
+        // and will default to datafile only
+        const bool isConnected = pDataHandler->getConnectionStatusWithSlurper();
+        shared::session::update(
+            [&](shared::session::SessionSnapshot& session) {
+                session.isConnected = isConnected;
+            });
+    }
+
+    if (!shared::session::get()->isConnected) {
+        nextStage(ConnectStage::kIdle);
+        return "Not connected to VATSIM!";
+    }
+
+    nextStage(ConnectStage::kSettingUpAudio);
+
+    if (pClient->IsAudioRunning()) {
+        pClient->StopAudio();
+    }
+    if (pClient->IsAPIConnected()) {
+        pClient->Disconnect(); // Force a disconnect of API
+    }
+
+    pClient->SetAudioApi(findAudioAPIorDefault());
+    pClient->SetAudioInputDevice(findHeadsetInputDeviceOrDefault());
+    pClient->SetAudioOutputDevice(findHeadsetOutputDeviceOrDefault());
+    pClient->SetAudioSpeakersOutputDevice(findSpeakerOutputDeviceOrDefault());
+    pClient->SetHardware(shared::hardware);
+    pClient->SetPlaybackChannelAll(util::OutputChannelToAfvPlaybackChannel(
+        shared::headsetOutputChannel));
+
+    nextStage(ConnectStage::kResolvingPosition);
+
+    resolveClientPosition();
+
+    nextStage(ConnectStage::kConnecting);
+
+    pClient->SetCredentials(
+        std::to_string(shared::vatsimCid), shared::vatsimPassword);
+    pClient->SetCallsign(shared::session::get()->callsign);
+    pClient->SetRadioGainAll(shared::radioGain / 100.0F);
+    if (!pClient->Connect()) {
+        spdlog::error("Failed to connect: afv_lib says API is connected.");
+    }
+
+    nextStage(ConnectStage::kIdle);
+    return std::nullopt;
+}
+
+void App::resolveClientPosition()
+{
+    const auto session = shared::session::get();
+
+    if (pDataHandler->isSlurperAvailable()) {
+        // The slurper has no altitude, the closest airport is a good enough
+        // estimate of the terrain under the client
+        int elevation = shared::defaultTransceiverPositionElevation;
+        if (auto nearest = pAirportDatabase.nearest(session->latitude,
+                session->longitude, shared::nearestAirportMaxDistanceKm)) {
+            elevation = nearest->elevation
+                + shared::airportTransceiverElevationOffset;
+            spdlog::info("Using the elevation of {}, the closest airport",
+                nearest->icao);
+        }
+
+        spdlog::info("Found client position from slurper at lat:{}, lon:{}",
+            session->latitude, session->longitude);
+        pClient->SetClientPosition(
+            session->latitude, session->longitude, elevation, elevation);
+        return;
+    }
+
+    // We use the airport database for this, it knows ICAO and IATA codes as
+    // well as the aliases from the config file
+    auto clientAirport = pAirportDatabase.resolveCallsign(session->callsign);
+
+    // Otherwise fall back to the airport closest to the last position the
+    // slurper gave us, if any
+    if (!clientAirport
+        && (session->latitude != 0.0 || session->longitude != 0.0)) {
+        clientAirport = pAirportDatabase.nearest(session->latitude,
+            session->longitude, shared::nearestAirportMaxDistanceKm);
+    }
+
+    if (clientAirport) {
+        // We pad the elevation by 10 meters to simulate the
+        // client being in a tower
+        pClient->SetClientPosition(clientAirport->lat, clientAirport->lon,
+            clientAirport->elevation
+                + shared::airportTransceiverElevationOffset,
+            clientAirport->elevation
+                + shared::airportTransceiverElevationOffset);
+
+        spdlog::info("Found client position in database at "
+                     "lat:{}, lon:{}, elev:{}",
+            clientAirport->lat, clientAirport->lon, clientAirport->elevation);
+    } else {
+        spdlog::warn("Client position is unknown, setting default.");
+
+        // Default position is over Paris somewhere
+        pClient->SetClientPosition(48.967860, 2.442000,
+            shared::defaultTransceiverPositionElevation,
+            shared::defaultTransceiverPositionElevation);
+    }
+}
+
+void App::handleConnectResult()
+{
+    if (!pConnectResult.valid()
+        || pConnectResult.wait_for(std::chrono::seconds(0))
+            != std::future_status::ready) {
+        return;
+    }
+
+    auto error = pConnectResult.get();
+    if (error) {
+        errorModal(*error);
+    }
+}
+
+const char* App::connectStageLabel(ConnectStage stage)
+{
+    switch (stage) {
+    case ConnectStage::kIdle:
+        return "Connect";
+    case ConnectStage::kCheckingSession:
+        return "Checking session...";
+    case ConnectStage::kSettingUpAudio:
+        return "Setting up audio...";
+    case ConnectStage::kResolvingPosition:
+        return "Resolving position...";
+    case ConnectStage::kConnecting:
+        return "Connecting...";
+    }
+
+    return "Connect";
+}
+} // namespace application
@@ -28,6 +28,9 @@ void Configuration::build_config()
     mAirportsDBFilePath
         = (get_resource_folder() / std::filesystem::path(mAirportsDBFilePath))
               .string();
+    mAirportsIndexFilePath = (get_resource_folder()
+        / std::filesystem::path(mAirportsIndexFilePath))
+                                 .string();
 
     if (std::filesystem::exists(configFilePath)) {
         vector_audio::Configuration::mConfig = toml::parse(configFilePath);
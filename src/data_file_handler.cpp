@@ -1,112 +1,106 @@
 
 #include <data_file_handler.h>
 
-vector_audio::vatsim::DataHandler::DataHandler()
-    : pWorkerThread(std::make_unique<std::thread>(&DataHandler::worker, this))
+vector_audio::vatsim::DataHandler::DataHandler(Endpoints endpoints)
+    : pEndpoints(std::move(endpoints))
 {
+    if (!pEndpoints.isLive()) {
+        spdlog::warn("Using custom VATSIM endpoints {} and {}",
+            pEndpoints.statusHost, pEndpoints.slurperHost);
+    }
+
+    // Started last so that the worker never sees a member being constructed
+    pWorkerThread = std::make_unique<std::thread>(&DataHandler::worker, this);
     spdlog::debug("Created data file thread");
 }
 
 std::string vector_audio::vatsim::DataHandler::downloadString(
-    httplib::Client& cli, std::string url)
+    const std::string& host, const std::string& url)
 {
-    auto res = cli.Get(url);
-    if (!res) {
-        spdlog::error("Could not download URL: {}", url);
-        return "";
-    }
-
-    if (res->status != 200) {
-        spdlog::error("Couldn't load {}, HTTP error {}", url, res->status);
+    std::string body;
+    if (net::HttpFetcher::instance().fetch(host, url, body)
+        == net::FetchStatus::kError) {
         return "";
     }
 
-    return res->body;
+    return body;
 }
 
 bool vector_audio::vatsim::DataHandler::parseSlurper(
-    const std::string& sluper_data)
+    std::string_view sluper_data)
 {
     if (sluper_data.empty()) {
         return false;
     }
 
-    auto lines = absl::StrSplit(sluper_data, '\n');
-    std::string callsign;
-    std::string res3;
-    std::string res2;
-    std::string lat;
-    std::string lon;
+    SlurperEntry entry;
     bool foundNotAtisConnection = false;
 
-    for (const auto& line : lines) {
-        if (line.empty()) {
+    std::string_view line;
+    while (SlurperParser::nextLine(sluper_data, line)) {
+        if (line.empty() || !SlurperParser::splitLine(line, entry)) {
             continue;
         }
 
-        std::vector<std::string> res = absl::StrSplit(line, ',');
-
-        if (absl::EndsWith(res[1], "_ATIS")) {
+        if (SlurperParser::endsWith(entry.callsign, "_ATIS")) {
             continue; // Ignore ATIS connections
         }
 
         foundNotAtisConnection = true;
-
-        auto allowedYx = { "_CTR", "_APP", "_TWR", "_GND", "_DEL", "_FSS",
-            "_SUP", "_RDO", "_RMP", "_TMU", "_FMP" };
-
-        for (const auto& yxTest : allowedYx) {
-            if (absl::EndsWith(res[1], yxTest)) {
-                pYx = true;
-                break;
-            }
-        }
-
-        callsign = res[1];
-        res3 = res[3];
-        res2 = res[2];
-
-        lat = res[5];
-        lon = res[6];
-
         break;
     }
 
+    if (!foundNotAtisConnection) {
+        return false;
+    }
+
+    std::string callsign(entry.callsign);
     if (callsign == "DCLIENT3") {
         return false;
     }
 
-    if (!foundNotAtisConnection) {
+    int frequency = 0;
+    double lat = 0;
+    double lon = 0;
+    if (!SlurperParser::parseFrequencyKhz(entry.frequency, frequency)) {
+        spdlog::error("Could not parse slurper entry for {}", callsign);
         return false;
     }
 
-    res3.erase(std::remove(res3.begin(), res3.end(), '.'), res3.end());
-    int u334 = std::atoi(res3.c_str()) * 1000;
+    // A missing position is not worth dropping the session over
+    if (!SlurperParser::parseDouble(entry.latitude, lat)
+        || !SlurperParser::parseDouble(entry.longitude, lon)) {
+        lat = 0;
+        lon = 0;
+    }
 
-    int k422 = std::stoi(res2, nullptr, 16) == 10 && pYx ? 1 : 0;
+    int u334 = frequency * 1000;
+
+    const bool yx = SlurperParser::hasTransmittingSuffix(callsign);
+    int k422 = entry.type == "atc" && yx ? 1 : 0;
 
     k422 = u334 != shared::kObsFrequency && k422 == 1   ? 1
         : k422 == 1 && absl::EndsWith(callsign, "_SUP") ? 1
                                                         : 0;
 
-    if (shared::session::isConnected && shared::session::callsign != callsign) {
+    auto session = shared::session::get();
+    if (session->isConnected && session->callsign != callsign) {
         spdlog::warn(
             "Detected an active session but with a different callsign");
         return false; // If the callsign changes during an active session, we
                       // disconnect
     }
 
-    vector_audio::vatsim::DataHandler::updateSessionInfo(callsign,
-        util::cleanUpFrequency(u334), k422, std::atof(lat.c_str()),
-        std::atof(lon.c_str()));
+    vector_audio::vatsim::DataHandler::updateSessionInfo(
+        callsign, util::cleanUpFrequency(u334), k422, lat, lon);
 
     return true;
 }
 
 bool vector_audio::vatsim::DataHandler::getLatestDatafileURL()
 {
-    auto cli = httplib::Client(vatsim_status_host);
-    auto res = this->downloadString(cli, vatsim_status_url);
+    auto res = vector_audio::vatsim::DataHandler::downloadString(
+        pEndpoints.statusHost, pEndpoints.statusPath);
 
     try {
         if (!nlohmann::json::accept(res)) {
@@ -115,23 +109,24 @@ bool vector_audio::vatsim::DataHandler::getLatestDatafileURL()
 
         auto statusJson = nlohmann::json::parse(res);
 
-        auto numberOfStatusFiles
-            = statusJson["data"]["v3"].get<std::vector<std::string>>().size();
-
-        auto selectedFileIndex
-            = numberOfStatusFiles == 1 ? 0 : std::rand() % numberOfStatusFiles;
-
-        auto data
-            = statusJson["data"]["v3"][selectedFileIndex].get<std::string>();
-
+        std::vector<Mirror> mirrors;
         std::regex regex(url_regex);
-        std::smatch m;
-        std::regex_match(data, m, regex);
-        if (m.size() == 4) {
-            pDatafileHost = m[1].str() + m[2].str();
-            pDatafileUrl = m[3].str();
-            return true;
+        for (const auto& data :
+            statusJson["data"]["v3"].get<std::vector<std::string>>()) {
+            std::smatch m;
+            std::regex_match(data, m, regex);
+            if (m.size() == 4) {
+                mirrors.push_back({ m[1].str() + m[2].str(), m[3].str() });
+            }
         }
+
+        if (mirrors.empty()) {
+            return false;
+        }
+
+        pMirrors.setMirrors(std::move(mirrors));
+        pMirrors.probeAll();
+        return true;
     } catch (std::exception& e) {
         spdlog::error("Status file check failed: %s", e.what());
     }
@@ -141,48 +136,53 @@ bool vector_audio::vatsim::DataHandler::getLatestDatafileURL()
 
 bool vector_audio::vatsim::DataHandler::checkIfdatafileAvailable()
 {
-    auto cli = httplib::Client(this->pDatafileHost);
-    auto res = vector_audio::vatsim::DataHandler::downloadString(
-        cli, this->pDatafileUrl);
+    // The mirrors have just been probed, no need to download anything
+    if (pMirrors.hasReachableMirror()) {
+        return true;
+    }
 
-    return !res.empty();
+    // None of them answered a probe, try a real download, which at least
+    // leaves us with a snapshot if it works
+    const std::lock_guard<std::mutex> l(this->pSnapshotFetchMutex);
+    return this->refreshDatafileSnapshot(false) != nullptr;
 }
 
-bool vector_audio::vatsim::DataHandler::checkIfSlurperAvailable()
+bool vector_audio::vatsim::DataHandler::checkIfSlurperAvailable() const
 {
-    auto cli = httplib::Client(slurper_host);
-    auto res
-        = vector_audio::vatsim::DataHandler::downloadString(cli, slurper_url);
+    auto res = vector_audio::vatsim::DataHandler::downloadString(
+        pEndpoints.slurperHost, pEndpoints.slurperPath);
 
     return res == "Must Provide CID";
 }
 
 void vector_audio::vatsim::DataHandler::getAvailableEndpoints()
 {
-    auto statusAvailable = this->getLatestDatafileURL();
-    if (statusAvailable) {
+    // Only look again at the sources that are down
+    if (!this->isDatafileAvailable() && this->getLatestDatafileURL()) {
         this->pDataFileAvailable = this->checkIfdatafileAvailable();
     }
 
-    this->pSlurperAvailable
-        = vector_audio::vatsim::DataHandler::checkIfSlurperAvailable();
+    if (!this->isSlurperAvailable()) {
+        this->pSlurperAvailable = this->checkIfSlurperAvailable();
+    }
 }
 
 void vector_audio::vatsim::DataHandler::resetSessionData()
 {
-    shared::session::isConnected = false;
-    shared::session::callsign.clear();
-    shared::session::facility = 0;
-    shared::session::frequency = 0;
-
-    shared::session::latitude = 0.0;
-    shared::session::longitude = 0.0;
+    shared::session::update([](shared::session::SessionSnapshot& session) {
+        session.isConnected = false;
+        session.callsign.clear();
+        session.facility = 0;
+        session.frequency = 0;
+
+        session.latitude = 0.0;
+        session.longitude = 0.0;
+    });
 }
 
 void vector_audio::vatsim::DataHandler::handleDisconnect()
 {
-    const std::lock_guard<std::mutex> l(shared::session::m);
-    if (!shared::session::isConnected) {
+    if (!shared::session::get()->isConnected) {
         return;
     }
 
@@ -196,99 +196,173 @@ void vector_audio::vatsim::DataHandler::handleDisconnect()
                  "confirmation.");
 
     this->pHadOneDisconnect = true;
+    pScheduler.requestFastPolling(1);
 }
 
-bool vector_audio::vatsim::DataHandler::parseDatafile(const std::string& data)
+vector_audio::net::FetchStatus
+vector_audio::vatsim::DataHandler::streamDatafile(
+    DatafileStreamParser& parser, const Mirror& mirror, bool conditional)
 {
-    try {
-        if (!nlohmann::json::accept(data)) {
-            spdlog::error("Failed to parse datafile: not valid JSON");
-            return false;
-        }
+    auto status = net::HttpFetcher::instance().stream(
+        mirror.host, mirror.path,
+        [&](const char* data, size_t length) {
+            return parser.feed(data, length);
+        },
+        conditional);
+
+    if (status != net::FetchStatus::kOk) {
+        return status;
+    }
 
-        auto v3Datafile = nlohmann::json::parse(data);
+    if (parser.isMalformed()) {
+        spdlog::error("Failed to parse datafile: not valid JSON");
+        return net::FetchStatus::kError;
+    }
 
-        for (auto controller : v3Datafile["controllers"]) {
-            if (controller["cid"] == vector_audio::shared::vatsimCid) {
+    spdlog::debug("Scanned {} bytes of datafile in {}us{}",
+        parser.bytesScanned(), parser.parseTime().count(),
+        parser.isStopped() ? " (stopped early)" : "");
 
-                auto callsign = controller["callsign"].get<std::string>();
-                if (shared::session::isConnected
-                    && shared::session::callsign != callsign) {
-                    spdlog::warn("Detected an active session but with a "
-                                 "different callsign, disconnecting");
-                    return false; // If the callsign changes during an
-                                  // active session, we disconnect
-                }
+    return parser.isStopped() || parser.isComplete()
+        ? net::FetchStatus::kOk
+        : net::FetchStatus::kError;
+}
 
-                auto res3 = controller["frequency"].get<std::string>();
-                res3.erase(
-                    std::remove(res3.begin(), res3.end(), '.'), res3.end());
-                int u334 = std::atoi(res3.c_str()) * 1000;
+bool vector_audio::vatsim::DataHandler::parseDatafileController(
+    const DatafileRecord& controller)
+{
+    auto session = shared::session::get();
+    if (session->isConnected && session->callsign != controller.callsign) {
+        spdlog::warn("Detected an active session but with a "
+                     "different callsign, disconnecting");
+        return false; // If the callsign changes during an
+                      // active session, we disconnect
+    }
 
-                vector_audio::vatsim::DataHandler::updateSessionInfo(callsign,
-                    util::cleanUpFrequency(u334),
-                    controller["facility"].get<int>());
+    auto res3 = controller.frequency;
+    res3.erase(std::remove(res3.begin(), res3.end(), '.'), res3.end());
+    int u334 = std::atoi(res3.c_str()) * 1000;
 
-                return true;
-            }
-        }
-    } catch (std::exception& e) {
-        spdlog::error("Failed to parse datafile: %s", e.what());
-    }
+    vector_audio::vatsim::DataHandler::updateSessionInfo(
+        controller.callsign, util::cleanUpFrequency(u334), controller.facility);
 
-    return false;
+    return true;
 }
 
 void vector_audio::vatsim::DataHandler::updateSessionInfo(std::string callsign,
     int frequency, int facility, double latitude, double longitude)
 {
-    const std::lock_guard<std::mutex> l(shared::session::m);
-    shared::session::callsign = std::move(callsign);
-    shared::session::facility = facility;
-    shared::session::latitude = latitude;
-    shared::session::longitude = longitude;
-    shared::session::frequency = frequency;
+    shared::session::update([&](shared::session::SessionSnapshot& session) {
+        session.callsign = std::move(callsign);
+        session.facility = facility;
+        session.latitude = latitude;
+        session.longitude = longitude;
+        session.frequency = frequency;
+    });
 }
 
 void vector_audio::vatsim::DataHandler::handleConnect()
 {
-    const std::lock_guard<std::mutex> l(shared::session::m);
-    if (shared::session::isConnected) {
+    this->pHadOneDisconnect = false;
+    if (shared::session::get()->isConnected) {
         return;
     }
 
     spdlog::info("Detected VATSIM client connection");
-    shared::session::isConnected = true;
+    shared::session::update([](shared::session::SessionSnapshot& session) {
+        session.isConnected = true;
+    });
 }
 
 void vector_audio::vatsim::DataHandler::worker()
 {
-    {
-        const std::lock_guard<std::mutex> l(shared::session::m);
-        this->getAvailableEndpoints();
-    }
-
-    std::unique_lock<std::mutex> lk(pDfMutex);
-    do {
+    while (pKeepRunning) {
         if (!this->isSlurperAvailable() || !this->isDatafileAvailable()) {
             this->getAvailableEndpoints();
         }
 
+        if (pMirrors.isProbeDue()) {
+            pMirrors.probeAll();
+        }
+
         auto res = false;
+        auto outcome = PollScheduler::Outcome::kError;
+        PollScheduler::Clock::duration floor {};
 
         if (this->isSlurperAvailable()) {
             res = this->getConnectionStatusWithSlurper();
+            outcome = PollScheduler::Outcome::kNotConnected;
         } else if (this->isDatafileAvailable()) {
             res = this->getConnectionStatusWithDatafile();
+            outcome = PollScheduler::Outcome::kNotConnected;
+
+            // Polling before the snapshot expires would only re-read it
+            if (auto snapshot = std::atomic_load(&pDatafileSnapshot)) {
+                floor = snapshot->getFetchedAt() + kDatafileSnapshotTtl
+                    - PollScheduler::Clock::now();
+            }
         }
 
         if (!res) {
             handleDisconnect();
         } else {
             handleConnect();
+            outcome = PollScheduler::Outcome::kConnected;
         }
 
-    } while (!pCv.wait_for(lk, 15s, [this] { return !pKeepRunning; }));
+        auto interval = pScheduler.schedule(outcome, floor);
+        spdlog::trace("Next VATSIM poll in {}ms",
+            std::chrono::duration_cast<std::chrono::milliseconds>(interval)
+                .count());
+
+        std::unique_lock<std::mutex> lk(pDfMutex);
+        pCv.wait_until(lk, pScheduler.getNextPollAt(),
+            [this] { return !pKeepRunning || pWakeRequested; });
+        pWakeRequested = false;
+    }
+}
+
+std::optional<std::chrono::milliseconds>
+vector_audio::vatsim::DataHandler::getSlurperLatency() const
+{
+    auto stats = net::HttpClientPool::instance().getStats();
+    auto it = stats.find(pEndpoints.slurperHost);
+    if (it == stats.end()) {
+        return std::nullopt;
+    }
+
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        it->second.lastLatency);
+}
+
+void vector_audio::vatsim::DataHandler::wake()
+{
+    {
+        const std::lock_guard<std::mutex> l(pDfMutex);
+        pWakeRequested = true;
+    }
+    pCv.notify_one();
+}
+
+void vector_audio::vatsim::DataHandler::requestFastPolling()
+{
+    pScheduler.requestFastPolling();
+    this->wake();
+}
+
+void vector_audio::vatsim::DataHandler::setWindowFocused(bool focused)
+{
+    if (pWindowFocused == focused) {
+        return;
+    }
+
+    pWindowFocused = focused;
+    pScheduler.setFocused(focused);
+
+    // The idle interval is much longer in the background, catch up on return
+    if (focused && !shared::session::get()->isConnected) {
+        this->wake();
+    }
 }
 
 bool vector_audio::vatsim::DataHandler::getConnectionStatusWithSlurper()
@@ -301,15 +375,10 @@ bool vector_audio::vatsim::DataHandler::getConnectionStatusWithSlurper()
         return false;
     }
 
-    auto cli = httplib::Client(slurper_host);
-    std::string res;
-    {
-        const std::lock_guard<std::mutex> l(shared::session::m);
-        std::string urlWithParams
-            = std::string(slurper_url) + std::to_string(shared::vatsimCid);
-        res = vector_audio::vatsim::DataHandler::downloadString(
-            cli, urlWithParams);
-    }
+    std::string urlWithParams
+        = pEndpoints.slurperPath + std::to_string(shared::vatsimCid);
+    std::string res = vector_audio::vatsim::DataHandler::downloadString(
+        pEndpoints.slurperHost, urlWithParams);
 
     return this->parseSlurper(res);
 }
@@ -320,11 +389,18 @@ bool vector_audio::vatsim::DataHandler::getConnectionStatusWithDatafile()
         return false;
     }
 
-    auto cli = httplib::Client(this->pDatafileHost);
-    std::string res = vector_audio::vatsim::DataHandler::downloadString(
-        cli, this->pDatafileUrl);
+    auto snapshot = this->getDatafileSnapshot(false);
+    if (!snapshot) {
+        return false;
+    }
 
-    return this->parseDatafile(res);
+    const auto* controller = snapshot->findControllerByCid(shared::vatsimCid);
+    if (controller == nullptr) {
+        return false;
+    }
+
+    return vector_audio::vatsim::DataHandler::parseDatafileController(
+        *controller);
 }
 
 bool vector_audio::vatsim::DataHandler::getPilotPositionWithSlurper(
@@ -334,29 +410,29 @@ bool vector_audio::vatsim::DataHandler::getPilotPositionWithSlurper(
         return false;
     }
 
-    auto cli = httplib::Client(slurper_host);
-    std::string res;
-    std::string urlWithParams = std::string(slurper_url) + callsign;
-    res = vector_audio::vatsim::DataHandler::downloadString(cli, urlWithParams);
+    std::string urlWithParams = pEndpoints.slurperPath + callsign;
+    std::string res = vector_audio::vatsim::DataHandler::downloadString(
+        pEndpoints.slurperHost, urlWithParams);
 
     if (res.empty()) {
         return false;
     }
 
-    try {
-        auto lines = absl::StrSplit(res, '\n');
-        for (const auto& line : lines) {
-            std::vector<std::string> splits = absl::StrSplit(line, ',');
-
-            if (splits[2] == "pilot") {
-                latitude = std::stod(splits[5]);
-                longitude = std::stod(splits[6]);
+    std::string_view data = res;
+    std::string_view line;
+    SlurperEntry entry;
+    while (SlurperParser::nextLine(data, line)) {
+        if (!SlurperParser::splitLine(line, entry) || entry.type != "pilot") {
+            continue;
+        }
 
-                return true;
-            }
+        if (SlurperParser::parseDouble(entry.latitude, latitude)
+            && SlurperParser::parseDouble(entry.longitude, longitude)) {
+            return true;
         }
-    } catch (const std::exception& e) {
-        spdlog::error("Error parsing pilot slurper position: %s", e.what());
+
+        spdlog::error("Error parsing pilot slurper position for {}", callsign);
+        break;
     }
 
     return false;
@@ -369,36 +445,20 @@ bool vector_audio::vatsim::DataHandler::getPilotPositionWithDatafile(
         return false;
     }
 
-    auto cli = httplib::Client(this->pDatafileHost);
-    std::string res = vector_audio::vatsim::DataHandler::downloadString(
-        cli, this->pDatafileUrl);
-
-    if (res.empty()) {
+    auto snapshot = this->getDatafileSnapshot(true);
+    if (!snapshot) {
         return false;
     }
 
-    try {
-        if (!nlohmann::json::accept(res)) {
-            spdlog::error("Failed to parse pilot datafile: not valid JSON");
-            return false;
-        }
-
-        auto v3Datafile = nlohmann::json::parse(res);
-
-        for (auto pilot : v3Datafile["pilots"]) {
-            if (pilot["callsign"] == callsign) {
-
-                latitude = pilot["latitude"].get<double>();
-                longitude = pilot["longitude"].get<double>();
-
-                return true;
-            }
-        }
-    } catch (const std::exception& e) {
-        spdlog::error("Failed to parse pilot datafile: %s", e.what());
+    const auto* pilot = snapshot->findPilot(callsign);
+    if (pilot == nullptr) {
+        return false;
     }
 
-    return false;
+    latitude = pilot->latitude;
+    longitude = pilot->longitude;
+
+    return true;
 }
 
 bool vector_audio::vatsim::DataHandler::getPilotPositionWithAnything(
@@ -415,3 +475,96 @@ bool vector_audio::vatsim::DataHandler::getPilotPositionWithAnything(
 
     return false;
 }
+
+std::shared_ptr<const vector_audio::vatsim::DatafileSnapshot>
+vector_audio::vatsim::DataHandler::getDatafileSnapshot(bool withPilots)
+{
+    auto usable = [&](const auto& snapshot) {
+        return snapshot && snapshot->isFresh()
+            && snapshot->covers(shared::vatsimCid, withPilots);
+    };
+
+    auto snapshot = std::atomic_load(&this->pDatafileSnapshot);
+    if (usable(snapshot)) {
+        return snapshot;
+    }
+
+    const std::lock_guard<std::mutex> l(this->pSnapshotFetchMutex);
+
+    // Someone else may have refreshed it while we were waiting
+    snapshot = std::atomic_load(&this->pDatafileSnapshot);
+    if (usable(snapshot)) {
+        return snapshot;
+    }
+
+    if (!this->isDatafileAvailable()) {
+        return nullptr;
+    }
+
+    return this->refreshDatafileSnapshot(withPilots);
+}
+
+std::shared_ptr<const vector_audio::vatsim::DatafileSnapshot>
+vector_audio::vatsim::DataHandler::refreshDatafileSnapshot(bool withPilots)
+{
+    using Section = DatafileStreamParser::Section;
+
+    auto snapshot = std::atomic_load(&this->pDatafileSnapshot);
+    const int cid = shared::vatsimCid;
+
+    // Try the mirrors from best to worst, so that a failing one does not
+    // cost us this refresh
+    for (const auto& mirror : pMirrors.ranked()) {
+        auto fresh = std::make_shared<DatafileSnapshot>(
+            kDatafileSnapshotTtl, withPilots);
+        auto handler = [&](Section section, std::string_view element) {
+            fresh->addElement(section, element);
+
+            // Once our own entry is in, the session watcher has all it needs
+            return withPilots || section != Section::kControllers
+                || fresh->findControllerByCid(cid) == nullptr;
+        };
+        auto parser = withPilots
+            ? DatafileStreamParser({ Section::kGeneral, Section::kPilots,
+                                       Section::kControllers },
+                  handler)
+            : DatafileStreamParser(
+                  { Section::kGeneral, Section::kControllers }, handler);
+
+        // Another mirror's validators say nothing about our snapshot, and a
+        // 304 is no use if the snapshot lacks what we are refreshing for
+        const bool conditional = snapshot != nullptr
+            && mirror == this->pSnapshotMirror
+            && snapshot->covers(cid, withPilots);
+        auto status = this->streamDatafile(parser, mirror, conditional);
+        if (status == net::FetchStatus::kError) {
+            pMirrors.recordFailure(mirror);
+            continue;
+        }
+
+        pMirrors.recordSuccess(mirror);
+        this->pSnapshotMirror = mirror;
+
+        if (status == net::FetchStatus::kNotModified) {
+            spdlog::debug("Datafile not modified, keeping snapshot {}",
+                snapshot->getUpdateTimestamp());
+            snapshot = snapshot->renewed();
+            std::atomic_store(&this->pDatafileSnapshot, snapshot);
+            return snapshot;
+        }
+
+        fresh->setControllersComplete(!parser.isStopped());
+        spdlog::debug("Indexed {} pilots and {} controllers from datafile {}",
+            fresh->pilotCount(), fresh->controllerCount(),
+            fresh->getUpdateTimestamp());
+
+        snapshot = std::move(fresh);
+        std::atomic_store(&this->pDatafileSnapshot, snapshot);
+
+        return snapshot;
+    }
+
+    spdlog::error("Could not download the datafile from any mirror");
+    this->pDataFileAvailable = false;
+    return nullptr;
+}
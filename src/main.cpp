@@ -7,9 +7,11 @@
 #include "native/window_manager.h"
 #include "shared.h"
 #include "spdlog/spdlog.h"
+#include "ui/frame_pacer.h"
 #include "ui/style.h"
 #include "updater.h"
 
+#include <chrono>
 #include <cstdio>
 #include <filesystem>
 #include <memory>
@@ -34,7 +36,6 @@ int main(int, char**)
 
     vector_audio::Configuration::build_logger();
     sf::RenderWindow window(sf::VideoMode(800, 600), "VectorAudio");
-    window.setFramerateLimit(30);
 
     auto image = sf::Image {};
 
@@ -86,7 +87,10 @@ int main(int, char**)
 
     auto updaterInstance = std::make_unique<vector_audio::Updater>();
 
-    auto currentApp = std::make_unique<vector_audio::application::App>();
+    // Declared before the app, whose client callbacks use it until the end
+    vector_audio::ui::FramePacer framePacer;
+    auto currentApp
+        = std::make_unique<vector_audio::application::App>(framePacer);
 
     bool alwaysOnTop = vector_audio::shared::keepWindowOnTop;
     vector_audio::setAlwaysOnTop(window, alwaysOnTop);
@@ -106,9 +110,14 @@ int main(int, char**)
         sf::Event event;
         while (window.pollEvent(event)) {
             ImGui::SFML::ProcessEvent(window, event);
+            framePacer.wake();
 
             if (event.type == sf::Event::Closed) {
                 window.close();
+            } else if (event.type == sf::Event::GainedFocus) {
+                vector_audio::shared::isWindowFocused = true;
+            } else if (event.type == sf::Event::LostFocus) {
+                vector_audio::shared::isWindowFocused = false;
             } else if (event.type == sf::Event::KeyPressed) {
                 // Capture the new Ptt key
                 if (vector_audio::shared::capturePttFlag) {
@@ -184,6 +193,12 @@ int main(int, char**)
             }
         }
 
+        // Sleeps while nothing changes on screen
+        if (!framePacer.waitForFrame()) {
+            continue;
+        }
+
+        const auto frameStart = vector_audio::ui::FramePacer::Clock::now();
         ImGui::SFML::Update(window, deltaClock.restart());
 
         if (!updaterInstance->need_update())
@@ -196,7 +211,17 @@ int main(int, char**)
         // Rendering
         window.clear();
         ImGui::SFML::Render(window);
+        const auto presentStart = vector_audio::ui::FramePacer::Clock::now();
         window.display();
+        const auto frameEnd = vector_audio::ui::FramePacer::Clock::now();
+
+        framePacer.frameDrawn(
+            presentStart - frameStart, frameEnd - presentStart);
+        // A focused text field shows a blinking cursor
+        framePacer.setContinuous(
+            (!updaterInstance->need_update()
+                && currentApp->wantsContinuousFrames())
+            || io.WantTextInput);
     }
 
     ImGui::SFML::Shutdown();
@@ -0,0 +1,413 @@
+#include "native/ptt_monitor.h"
+
+#include <SFML/Config.hpp>
+
+#ifdef SFML_SYSTEM_LINUX
+#include <spdlog/spdlog.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <linux/joystick.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#endif
+
+namespace vector_audio::native {
+
+#ifdef SFML_SYSTEM_LINUX
+namespace {
+    struct KeyMapping {
+        sf::Keyboard::Scancode scancode;
+        int code;
+    };
+
+    // SFML scancodes follow the USB HID usage table, evdev has its own codes
+    const KeyMapping kKeyMappings[] = {
+        { sf::Keyboard::Scan::A, KEY_A },
+        { sf::Keyboard::Scan::B, KEY_B },
+        { sf::Keyboard::Scan::C, KEY_C },
+        { sf::Keyboard::Scan::D, KEY_D },
+        { sf::Keyboard::Scan::E, KEY_E },
+        { sf::Keyboard::Scan::F, KEY_F },
+        { sf::Keyboard::Scan::G, KEY_G },
+        { sf::Keyboard::Scan::H, KEY_H },
+        { sf::Keyboard::Scan::I, KEY_I },
+        { sf::Keyboard::Scan::J, KEY_J },
+        { sf::Keyboard::Scan::K, KEY_K },
+        { sf::Keyboard::Scan::L, KEY_L },
+        { sf::Keyboard::Scan::M, KEY_M },
+        { sf::Keyboard::Scan::N, KEY_N },
+        { sf::Keyboard::Scan::O, KEY_O },
+        { sf::Keyboard::Scan::P, KEY_P },
+        { sf::Keyboard::Scan::Q, KEY_Q },
+        { sf::Keyboard::Scan::R, KEY_R },
+        { sf::Keyboard::Scan::S, KEY_S },
+        { sf::Keyboard::Scan::T, KEY_T },
+        { sf::Keyboard::Scan::U, KEY_U },
+        { sf::Keyboard::Scan::V, KEY_V },
+        { sf::Keyboard::Scan::W, KEY_W },
+        { sf::Keyboard::Scan::X, KEY_X },
+        { sf::Keyboard::Scan::Y, KEY_Y },
+        { sf::Keyboard::Scan::Z, KEY_Z },
+        { sf::Keyboard::Scan::Num0, KEY_0 },
+        { sf::Keyboard::Scan::Num1, KEY_1 },
+        { sf::Keyboard::Scan::Num2, KEY_2 },
+        { sf::Keyboard::Scan::Num3, KEY_3 },
+        { sf::Keyboard::Scan::Num4, KEY_4 },
+        { sf::Keyboard::Scan::Num5, KEY_5 },
+        { sf::Keyboard::Scan::Num6, KEY_6 },
+        { sf::Keyboard::Scan::Num7, KEY_7 },
+        { sf::Keyboard::Scan::Num8, KEY_8 },
+        { sf::Keyboard::Scan::Num9, KEY_9 },
+        { sf::Keyboard::Scan::Enter, KEY_ENTER },
+        { sf::Keyboard::Scan::Escape, KEY_ESC },
+        { sf::Keyboard::Scan::Backspace, KEY_BACKSPACE },
+        { sf::Keyboard::Scan::Tab, KEY_TAB },
+        { sf::Keyboard::Scan::Space, KEY_SPACE },
+        { sf::Keyboard::Scan::Hyphen, KEY_MINUS },
+        { sf::Keyboard::Scan::Equal, KEY_EQUAL },
+        { sf::Keyboard::Scan::LBracket, KEY_LEFTBRACE },
+        { sf::Keyboard::Scan::RBracket, KEY_RIGHTBRACE },
+        { sf::Keyboard::Scan::Backslash, KEY_BACKSLASH },
+        { sf::Keyboard::Scan::Semicolon, KEY_SEMICOLON },
+        { sf::Keyboard::Scan::Apostrophe, KEY_APOSTROPHE },
+        { sf::Keyboard::Scan::Grave, KEY_GRAVE },
+        { sf::Keyboard::Scan::Comma, KEY_COMMA },
+        { sf::Keyboard::Scan::Period, KEY_DOT },
+        { sf::Keyboard::Scan::Slash, KEY_SLASH },
+        { sf::Keyboard::Scan::F1, KEY_F1 },
+        { sf::Keyboard::Scan::F2, KEY_F2 },
+        { sf::Keyboard::Scan::F3, KEY_F3 },
+        { sf::Keyboard::Scan::F4, KEY_F4 },
+        { sf::Keyboard::Scan::F5, KEY_F5 },
+        { sf::Keyboard::Scan::F6, KEY_F6 },
+        { sf::Keyboard::Scan::F7, KEY_F7 },
+        { sf::Keyboard::Scan::F8, KEY_F8 },
+        { sf::Keyboard::Scan::F9, KEY_F9 },
+        { sf::Keyboard::Scan::F10, KEY_F10 },
+        { sf::Keyboard::Scan::F11, KEY_F11 },
+        { sf::Keyboard::Scan::F12, KEY_F12 },
+        { sf::Keyboard::Scan::F13, KEY_F13 },
+        { sf::Keyboard::Scan::F14, KEY_F14 },
+        { sf::Keyboard::Scan::F15, KEY_F15 },
+        { sf::Keyboard::Scan::F16, KEY_F16 },
+        { sf::Keyboard::Scan::F17, KEY_F17 },
+        { sf::Keyboard::Scan::F18, KEY_F18 },
+        { sf::Keyboard::Scan::F19, KEY_F19 },
+        { sf::Keyboard::Scan::F20, KEY_F20 },
+        { sf::Keyboard::Scan::F21, KEY_F21 },
+        { sf::Keyboard::Scan::F22, KEY_F22 },
+        { sf::Keyboard::Scan::F23, KEY_F23 },
+        { sf::Keyboard::Scan::F24, KEY_F24 },
+        { sf::Keyboard::Scan::CapsLock, KEY_CAPSLOCK },
+        { sf::Keyboard::Scan::PrintScreen, KEY_SYSRQ },
+        { sf::Keyboard::Scan::ScrollLock, KEY_SCROLLLOCK },
+        { sf::Keyboard::Scan::Pause, KEY_PAUSE },
+        { sf::Keyboard::Scan::Insert, KEY_INSERT },
+        { sf::Keyboard::Scan::Home, KEY_HOME },
+        { sf::Keyboard::Scan::PageUp, KEY_PAGEUP },
+        { sf::Keyboard::Scan::Delete, KEY_DELETE },
+        { sf::Keyboard::Scan::End, KEY_END },
+        { sf::Keyboard::Scan::PageDown, KEY_PAGEDOWN },
+        { sf::Keyboard::Scan::Right, KEY_RIGHT },
+        { sf::Keyboard::Scan::Left, KEY_LEFT },
+        { sf::Keyboard::Scan::Down, KEY_DOWN },
+        { sf::Keyboard::Scan::Up, KEY_UP },
+        { sf::Keyboard::Scan::NumLock, KEY_NUMLOCK },
+        { sf::Keyboard::Scan::NumpadDivide, KEY_KPSLASH },
+        { sf::Keyboard::Scan::NumpadMultiply, KEY_KPASTERISK },
+        { sf::Keyboard::Scan::NumpadMinus, KEY_KPMINUS },
+        { sf::Keyboard::Scan::NumpadPlus, KEY_KPPLUS },
+        { sf::Keyboard::Scan::NumpadEqual, KEY_KPEQUAL },
+        { sf::Keyboard::Scan::NumpadEnter, KEY_KPENTER },
+        { sf::Keyboard::Scan::NumpadDecimal, KEY_KPDOT },
+        { sf::Keyboard::Scan::Numpad0, KEY_KP0 },
+        { sf::Keyboard::Scan::Numpad1, KEY_KP1 },
+        { sf::Keyboard::Scan::Numpad2, KEY_KP2 },
+        { sf::Keyboard::Scan::Numpad3, KEY_KP3 },
+        { sf::Keyboard::Scan::Numpad4, KEY_KP4 },
+        { sf::Keyboard::Scan::Numpad5, KEY_KP5 },
+        { sf::Keyboard::Scan::Numpad6, KEY_KP6 },
+        { sf::Keyboard::Scan::Numpad7, KEY_KP7 },
+        { sf::Keyboard::Scan::Numpad8, KEY_KP8 },
+        { sf::Keyboard::Scan::Numpad9, KEY_KP9 },
+        { sf::Keyboard::Scan::NonUsBackslash, KEY_102ND },
+        { sf::Keyboard::Scan::Application, KEY_COMPOSE },
+        { sf::Keyboard::Scan::Menu, KEY_MENU },
+        { sf::Keyboard::Scan::Help, KEY_HELP },
+        { sf::Keyboard::Scan::VolumeMute, KEY_MUTE },
+        { sf::Keyboard::Scan::VolumeUp, KEY_VOLUMEUP },
+        { sf::Keyboard::Scan::VolumeDown, KEY_VOLUMEDOWN },
+        { sf::Keyboard::Scan::MediaPlayPause, KEY_PLAYPAUSE },
+        { sf::Keyboard::Scan::MediaStop, KEY_STOPCD },
+        { sf::Keyboard::Scan::MediaNextTrack, KEY_NEXTSONG },
+        { sf::Keyboard::Scan::MediaPreviousTrack, KEY_PREVIOUSSONG },
+        { sf::Keyboard::Scan::LControl, KEY_LEFTCTRL },
+        { sf::Keyboard::Scan::LShift, KEY_LEFTSHIFT },
+        { sf::Keyboard::Scan::LAlt, KEY_LEFTALT },
+        { sf::Keyboard::Scan::LSystem, KEY_LEFTMETA },
+        { sf::Keyboard::Scan::RControl, KEY_RIGHTCTRL },
+        { sf::Keyboard::Scan::RShift, KEY_RIGHTSHIFT },
+        { sf::Keyboard::Scan::RAlt, KEY_RIGHTALT },
+        { sf::Keyboard::Scan::RSystem, KEY_RIGHTMETA },
+    };
+
+    int toEvdevKey(sf::Keyboard::Scancode scancode)
+    {
+        for (const auto& mapping : kKeyMappings) {
+            if (mapping.scancode == scancode) {
+                return mapping.code;
+            }
+        }
+        return -1;
+    }
+
+    bool testBit(const unsigned char* bits, int bit)
+    {
+        return (bits[bit / CHAR_BIT] & (1U << (bit % CHAR_BIT))) != 0;
+    }
+
+    std::vector<std::string> listDevices(const std::string& prefix)
+    {
+        std::vector<std::string> out;
+        DIR* dir = opendir("/dev/input");
+        if (dir == nullptr) {
+            return out;
+        }
+        while (const dirent* entry = readdir(dir)) {
+            if (std::strncmp(entry->d_name, prefix.c_str(), prefix.size())
+                == 0) {
+                out.push_back(std::string("/dev/input/") + entry->d_name);
+            }
+        }
+        closedir(dir);
+        return out;
+    }
+
+    /**
+     * Waits on the keyboards (event devices) or the joystick (joydev) that
+     * can report the bound input. Keyboard events carry the kernel timestamp
+     * of the key press, joystick events are timed when read.
+     */
+    class EvdevBackend : public PttBackend {
+    public:
+        struct Device {
+            int fd;
+            bool pressed;
+        };
+
+        EvdevBackend(std::vector<Device> devices, bool joystick, int code)
+            : pDevices(std::move(devices))
+            , pJoystick(joystick)
+            , pCode(code)
+        {
+        }
+
+        ~EvdevBackend() override
+        {
+            for (const auto& device : pDevices) {
+                ::close(device.fd);
+            }
+        }
+
+        EvdevBackend(const EvdevBackend&) = delete;
+        EvdevBackend& operator=(const EvdevBackend&) = delete;
+
+        bool wait(std::chrono::milliseconds timeout, bool& pressed,
+            std::chrono::steady_clock::time_point& seenAt) override
+        {
+            // The initial state read when opening may differ from the last
+            // known one
+            if (this->anyPressed() != pressed) {
+                pressed = this->anyPressed();
+                seenAt = std::chrono::steady_clock::now();
+                return true;
+            }
+
+            std::vector<pollfd> fds;
+            fds.reserve(pDevices.size());
+            for (const auto& device : pDevices) {
+                fds.push_back({ device.fd, POLLIN, 0 });
+            }
+
+            const int ready = poll(fds.data(), fds.size(),
+                static_cast<int>(timeout.count()));
+            if (ready < 0) {
+                return errno == EINTR;
+            }
+
+            for (size_t i = 0; i < fds.size(); i++) {
+                if ((fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0) {
+                    return false;
+                }
+                if ((fds[i].revents & POLLIN) != 0
+                    && !this->drain(pDevices[i], seenAt)) {
+                    return false;
+                }
+            }
+
+            pressed = this->anyPressed();
+            return true;
+        }
+
+        [[nodiscard]] const char* name() const override
+        {
+            return pJoystick ? "joydev events" : "evdev events";
+        }
+
+    private:
+        [[nodiscard]] bool anyPressed() const
+        {
+            for (const auto& device : pDevices) {
+                if (device.pressed) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool drain(
+            Device& device, std::chrono::steady_clock::time_point& seenAt)
+        {
+            while (true) {
+                if (pJoystick) {
+                    js_event event {};
+                    const auto n = read(device.fd, &event, sizeof(event));
+                    if (n != sizeof(event)) {
+                        return n < 0 && errno == EAGAIN;
+                    }
+                    if ((event.type & ~JS_EVENT_INIT) == JS_EVENT_BUTTON
+                        && event.number == pCode) {
+                        device.pressed = event.value != 0;
+                        seenAt = std::chrono::steady_clock::now();
+                    }
+                    continue;
+                }
+
+                input_event event {};
+                const auto n = read(device.fd, &event, sizeof(event));
+                if (n != sizeof(event)) {
+                    return n < 0 && errno == EAGAIN;
+                }
+                // Value 2 is auto repeat
+                if (event.type == EV_KEY && event.code == pCode
+                    && event.value != 2) {
+                    device.pressed = event.value != 0;
+                    seenAt = toSteadyClock(event);
+                }
+            }
+        }
+
+        // The devices are switched to CLOCK_MONOTONIC when opened, which is
+        // what steady_clock uses on Linux
+        static std::chrono::steady_clock::time_point toSteadyClock(
+            const input_event& event)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            const auto at = std::chrono::steady_clock::time_point(
+                std::chrono::duration_cast<
+                    std::chrono::steady_clock::duration>(
+                    std::chrono::seconds(event.input_event_sec)
+                    + std::chrono::microseconds(event.input_event_usec)));
+            return at <= now ? at : now;
+        }
+
+        std::vector<Device> pDevices;
+        bool pJoystick;
+        int pCode;
+    };
+
+    std::vector<EvdevBackend::Device> openKeyboards(int code)
+    {
+        std::vector<EvdevBackend::Device> devices;
+        for (const auto& path : listDevices("event")) {
+            const int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK);
+            if (fd < 0) {
+                continue;
+            }
+
+            unsigned char keys[KEY_MAX / CHAR_BIT + 1] = {};
+            if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) < 0
+                || !testBit(keys, code)) {
+                ::close(fd);
+                continue;
+            }
+
+            int clock = CLOCK_MONOTONIC;
+            ioctl(fd, EVIOCSCLOCKID, &clock);
+
+            unsigned char state[KEY_MAX / CHAR_BIT + 1] = {};
+            ioctl(fd, EVIOCGKEY(sizeof(state)), state);
+            devices.push_back({ fd, testBit(state, code) });
+        }
+        return devices;
+    }
+
+    std::vector<EvdevBackend::Device> openJoystick(const std::string& name)
+    {
+        std::vector<EvdevBackend::Device> devices;
+        for (const auto& path : listDevices("js")) {
+            const int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK);
+            if (fd < 0) {
+                continue;
+            }
+
+            char deviceName[128] = {};
+            if (ioctl(fd, JSIOCGNAME(sizeof(deviceName) - 1), deviceName) < 0
+                || name != deviceName) {
+                ::close(fd);
+                continue;
+            }
+
+            // joydev replays the current state as init events on open
+            devices.push_back({ fd, false });
+            break;
+        }
+        return devices;
+    }
+}
+
+std::unique_ptr<PttBackend> makeEvdevPttBackend(const PttBinding& binding)
+{
+    std::vector<EvdevBackend::Device> devices;
+    bool joystick = false;
+    int code = -1;
+
+    if (binding.joystickId != -1) {
+        if (binding.joystickName.empty()) {
+            return nullptr;
+        }
+        joystick = true;
+        code = binding.joystickButton;
+        devices = openJoystick(binding.joystickName);
+    } else if (binding.fallbackKey == sf::Keyboard::Unknown) {
+        code = toEvdevKey(binding.key);
+        if (code < 0) {
+            return nullptr;
+        }
+        devices = openKeyboards(code);
+    }
+
+    if (devices.empty()) {
+        spdlog::debug("No readable input device for the PTT, the user may "
+                      "need to be in the input group");
+        return nullptr;
+    }
+
+    return std::make_unique<EvdevBackend>(std::move(devices), joystick, code);
+}
+#else
+std::unique_ptr<PttBackend> makeEvdevPttBackend(const PttBinding&)
+{
+    return nullptr;
+}
+#endif
+}
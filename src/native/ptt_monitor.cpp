@@ -0,0 +1,344 @@
+#include "native/ptt_monitor.h"
+
+#include <SFML/Window/Joystick.hpp>
+#include <spdlog/spdlog.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#include <sys/qos.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace vector_audio::native {
+
+namespace {
+    void raiseThreadPriority()
+    {
+#if defined(_WIN32)
+        if (SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST)
+            == 0) {
+            spdlog::debug("Could not raise the PTT thread priority");
+        }
+#elif defined(__APPLE__)
+        if (pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0)
+            != 0) {
+            spdlog::debug("Could not raise the PTT thread priority");
+        }
+#elif defined(__linux__)
+        // Real time scheduling needs CAP_SYS_NICE or an rtprio limit, the
+        // thread simply keeps the normal policy otherwise
+        sched_param param {};
+        param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+            spdlog::debug("Could not give the PTT thread real time priority");
+        }
+#endif
+    }
+
+    /**
+     * Waits for the state the main thread samples through SFML.
+     */
+    class ForwardedBackend : public PttBackend {
+    public:
+        explicit ForwardedBackend(ForwardedPttSample& sample)
+            : pSample(sample)
+        {
+        }
+
+        bool wait(std::chrono::milliseconds timeout, bool& pressed,
+            std::chrono::steady_clock::time_point& seenAt) override
+        {
+            std::unique_lock<std::mutex> l(pSample.mutex);
+            pSample.changed.wait_for(
+                l, timeout, [&] { return pSample.pressed != pressed; });
+            if (pSample.pressed != pressed) {
+                pressed = pSample.pressed;
+                seenAt = pSample.seenAt;
+            }
+            return true;
+        }
+
+        [[nodiscard]] const char* name() const override
+        {
+            return "window polling";
+        }
+
+    private:
+        ForwardedPttSample& pSample;
+    };
+
+#if defined(_WIN32)
+    /**
+     * Polls a keyboard key, GetAsyncKeyState can be called from any thread.
+     */
+    class AsyncKeyStateBackend : public PttBackend {
+    public:
+        explicit AsyncKeyStateBackend(int virtualKey)
+            : pVirtualKey(virtualKey)
+        {
+        }
+
+        bool wait(std::chrono::milliseconds timeout, bool& pressed,
+            std::chrono::steady_clock::time_point& seenAt) override
+        {
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (true) {
+                const bool sample
+                    = (GetAsyncKeyState(pVirtualKey) & 0x8000) != 0;
+                const auto now = std::chrono::steady_clock::now();
+                if (sample != pressed) {
+                    pressed = sample;
+                    seenAt = now;
+                    return true;
+                }
+                if (now >= deadline) {
+                    return true;
+                }
+                std::this_thread::sleep_for(PttMonitor::kPollInterval);
+            }
+        }
+
+        [[nodiscard]] const char* name() const override
+        {
+            return "keyboard polling";
+        }
+
+    private:
+        int pVirtualKey;
+    };
+#endif
+
+    std::unique_ptr<PttBackend> makeThreadBackend(const PttBinding& binding)
+    {
+        auto backend = makeEvdevPttBackend(binding);
+#if defined(_WIN32)
+        if (!backend && binding.joystickId == -1 && binding.virtualKey != 0) {
+            backend
+                = std::make_unique<AsyncKeyStateBackend>(binding.virtualKey);
+        }
+#endif
+        return backend;
+    }
+}
+
+void LatencyHistogram::record(std::chrono::steady_clock::duration latency)
+{
+    const auto us
+        = std::chrono::duration_cast<std::chrono::microseconds>(latency)
+              .count();
+
+    size_t bucket = 0;
+    while (bucket + 1 < kBucketLimitsUs.size()
+        && us >= kBucketLimitsUs[bucket]) {
+        bucket++;
+    }
+    pCounts[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::array<uint64_t, LatencyHistogram::kBucketLimitsUs.size()>
+LatencyHistogram::counts() const
+{
+    std::array<uint64_t, kBucketLimitsUs.size()> out {};
+    for (size_t i = 0; i < out.size(); i++) {
+        out[i] = pCounts[i].load(std::memory_order_relaxed);
+    }
+    return out;
+}
+
+uint64_t LatencyHistogram::total() const
+{
+    uint64_t total = 0;
+    for (const auto& count : pCounts) {
+        total += count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+float LatencyHistogram::percentileMs(float percentile) const
+{
+    const auto counts = this->counts();
+    uint64_t total = 0;
+    for (auto count : counts) {
+        total += count;
+    }
+    if (total == 0) {
+        return -1.0F;
+    }
+
+    const auto target = static_cast<double>(total) * percentile;
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        cumulative += counts[i];
+        if (static_cast<double>(cumulative) >= target) {
+            return kBucketLimitsUs[i] > 0
+                ? static_cast<float>(kBucketLimitsUs[i]) / 1000.0F
+                : -1.0F;
+        }
+    }
+    return -1.0F;
+}
+
+PttMonitor::PttMonitor(Callback onChange)
+    : pOnChange(std::move(onChange))
+{
+    pThread = std::thread(&PttMonitor::run, this);
+}
+
+PttMonitor::~PttMonitor()
+{
+    {
+        const std::lock_guard<std::mutex> l(pMutex);
+        pStop = true;
+    }
+    pBindingChanged.notify_all();
+    if (pThread.joinable()) {
+        pThread.join();
+    }
+}
+
+void PttMonitor::setBinding(const PttBinding& binding)
+{
+    {
+        const std::lock_guard<std::mutex> l(pMutex);
+        if (binding == pBinding) {
+            return;
+        }
+        pBinding = binding;
+        pBindingVersion++;
+    }
+    pBindingChanged.notify_all();
+}
+
+std::string PttMonitor::getBackendName() const
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+    return pBackendName;
+}
+
+bool PttMonitor::sampledOnMainThread() const
+{
+    return pSampledOnMainThread.load();
+}
+
+bool PttMonitor::sampleWithSfml(const PttBinding& binding)
+{
+    if (binding.joystickId != -1) {
+        return sf::Joystick::isButtonPressed(
+            static_cast<unsigned int>(binding.joystickId),
+            static_cast<unsigned int>(binding.joystickButton));
+    }
+    if (binding.fallbackKey != sf::Keyboard::Unknown) {
+        return sf::Keyboard::isKeyPressed(binding.fallbackKey);
+    }
+    return sf::Keyboard::isKeyPressed(binding.key);
+}
+
+void PttMonitor::reportSample(bool pressed)
+{
+    const auto now = std::chrono::steady_clock::now();
+    {
+        const std::lock_guard<std::mutex> l(pSample.mutex);
+        const auto previous = pSample.sampledAt;
+        pSample.sampledAt = now;
+        if (pSample.pressed == pressed) {
+            return;
+        }
+        pSample.pressed = pressed;
+        // Counting from this frame would leave the wait for it out of the
+        // latency, which is most of it
+        pSample.seenAt
+            = previous == std::chrono::steady_clock::time_point {} ? now
+                                                                  : previous;
+    }
+    pSample.changed.notify_one();
+}
+
+void PttMonitor::run()
+{
+    raiseThreadPriority();
+
+    std::unique_ptr<PttBackend> backend;
+    PttBinding binding;
+    uint64_t bindingVersion = 0;
+    bool pressed = false;
+
+    while (true) {
+        bool bindingChanged = false;
+        {
+            std::unique_lock<std::mutex> l(pMutex);
+            // Nothing to watch until a binding is set
+            pBindingChanged.wait(l, [this, bindingVersion] {
+                return pStop || pBinding.isSet()
+                    || pBindingVersion != bindingVersion;
+            });
+            if (pStop) {
+                break;
+            }
+
+            bindingChanged = pBindingVersion != bindingVersion;
+            if (bindingChanged) {
+                binding = pBinding;
+                bindingVersion = pBindingVersion;
+            }
+        }
+
+        // Never leave the frequency transmitting on an input that is no
+        // longer watched
+        if (bindingChanged) {
+            backend.reset();
+            pSampledOnMainThread = false;
+            if (pressed) {
+                pressed = false;
+                pOnChange(false);
+            }
+        }
+        if (!binding.isSet()) {
+            continue;
+        }
+
+        if (!backend) {
+            backend = makeThreadBackend(binding);
+            const bool forwarded = !backend;
+            if (forwarded) {
+                // Whatever the main thread reported for the previous binding
+                // does not apply to this one
+                {
+                    const std::lock_guard<std::mutex> l(pSample.mutex);
+                    pSample.pressed = false;
+                    pSample.sampledAt = {};
+                }
+                backend = std::make_unique<ForwardedBackend>(pSample);
+            }
+            pSampledOnMainThread = forwarded;
+
+            spdlog::info("Reading the PTT through {}", backend->name());
+            const std::lock_guard<std::mutex> l(pMutex);
+            pBackendName = backend->name();
+        }
+
+        bool nowPressed = pressed;
+        auto seenAt = std::chrono::steady_clock::now();
+        if (!backend->wait(kWaitTimeout, nowPressed, seenAt)) {
+            // A device went away, open whatever is left after a short delay
+            spdlog::warn("PTT input device lost, reopening");
+            backend.reset();
+            std::this_thread::sleep_for(kWaitTimeout);
+            continue;
+        }
+
+        if (nowPressed != pressed) {
+            pressed = nowPressed;
+            pOnChange(pressed);
+            pLatency.record(std::chrono::steady_clock::now() - seenAt);
+        }
+    }
+
+    if (pressed) {
+        pOnChange(false);
+    }
+}
+}
@@ -1,5 +1,9 @@
 #include "native/win32_key_util.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
 std::string vector_audio::native::win32::get_key_description(
     sf::Keyboard::Scancode code)
 {
@@ -9,4 +13,119 @@ std::string vector_audio::native::win32::get_key_description(
     }
 
     return sf::Keyboard::getDescription(code).toAnsiString();
-}
\ No newline at end of file
+}
+#ifdef _WIN32
+int vector_audio::native::win32::get_virtual_key(
+    sf::Keyboard::Scancode code, sf::Keyboard::Key fallbackKey)
+{
+    using Key = sf::Keyboard::Key;
+
+    // Keys past F15 have no sf::Keyboard::Key
+    if (code >= sf::Keyboard::Scancode::F13
+        && code <= sf::Keyboard::Scancode::F24) {
+        return VK_F13 + static_cast<int>(code)
+            - static_cast<int>(sf::Keyboard::Scancode::F13);
+    }
+
+    const Key key = fallbackKey != Key::Unknown ? fallbackKey
+                                                : sf::Keyboard::localize(code);
+    if (key >= Key::A && key <= Key::Z) {
+        return 'A' + static_cast<int>(key) - static_cast<int>(Key::A);
+    }
+    if (key >= Key::Num0 && key <= Key::Num9) {
+        return '0' + static_cast<int>(key) - static_cast<int>(Key::Num0);
+    }
+    if (key >= Key::Numpad0 && key <= Key::Numpad9) {
+        return VK_NUMPAD0 + static_cast<int>(key)
+            - static_cast<int>(Key::Numpad0);
+    }
+    if (key >= Key::F1 && key <= Key::F15) {
+        return VK_F1 + static_cast<int>(key) - static_cast<int>(Key::F1);
+    }
+
+    switch (key) {
+    case Key::Escape:
+        return VK_ESCAPE;
+    case Key::LControl:
+        return VK_LCONTROL;
+    case Key::LShift:
+        return VK_LSHIFT;
+    case Key::LAlt:
+        return VK_LMENU;
+    case Key::LSystem:
+        return VK_LWIN;
+    case Key::RControl:
+        return VK_RCONTROL;
+    case Key::RShift:
+        return VK_RSHIFT;
+    case Key::RAlt:
+        return VK_RMENU;
+    case Key::RSystem:
+        return VK_RWIN;
+    case Key::Menu:
+        return VK_APPS;
+    case Key::LBracket:
+        return VK_OEM_4;
+    case Key::RBracket:
+        return VK_OEM_6;
+    case Key::Semicolon:
+        return VK_OEM_1;
+    case Key::Comma:
+        return VK_OEM_COMMA;
+    case Key::Period:
+        return VK_OEM_PERIOD;
+    case Key::Apostrophe:
+        return VK_OEM_7;
+    case Key::Slash:
+        return VK_OEM_2;
+    case Key::Backslash:
+        return VK_OEM_5;
+    case Key::Grave:
+        return VK_OEM_3;
+    case Key::Equal:
+        return VK_OEM_PLUS;
+    case Key::Hyphen:
+        return VK_OEM_MINUS;
+    case Key::Space:
+        return VK_SPACE;
+    case Key::Enter:
+        return VK_RETURN;
+    case Key::Backspace:
+        return VK_BACK;
+    case Key::Tab:
+        return VK_TAB;
+    case Key::PageUp:
+        return VK_PRIOR;
+    case Key::PageDown:
+        return VK_NEXT;
+    case Key::End:
+        return VK_END;
+    case Key::Home:
+        return VK_HOME;
+    case Key::Insert:
+        return VK_INSERT;
+    case Key::Delete:
+        return VK_DELETE;
+    case Key::Add:
+        return VK_ADD;
+    case Key::Subtract:
+        return VK_SUBTRACT;
+    case Key::Multiply:
+        return VK_MULTIPLY;
+    case Key::Divide:
+        return VK_DIVIDE;
+    case Key::Left:
+        return VK_LEFT;
+    case Key::Right:
+        return VK_RIGHT;
+    case Key::Up:
+        return VK_UP;
+    case Key::Down:
+        return VK_DOWN;
+    case Key::Pause:
+        return VK_PAUSE;
+    default:
+        return 0;
+    }
+}
+#endif
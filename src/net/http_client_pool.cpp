@@ -0,0 +1,79 @@
+#include "net/http_client_pool.h"
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace vector_audio::net {
+
+HttpClientPool& HttpClientPool::instance()
+{
+    static HttpClientPool pool;
+    return pool;
+}
+
+httplib::Result HttpClientPool::get(const std::string& host,
+    const std::string& path, const httplib::Headers& headers)
+{
+    return this->with(host,
+        [&](httplib::Client& cli) { return cli.Get(path, headers); });
+}
+
+std::map<std::string, HttpClientPool::HostStats> HttpClientPool::getStats()
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+    return pStats;
+}
+
+std::unique_ptr<httplib::Client> HttpClientPool::acquire(
+    const std::string& host, bool& reused)
+{
+    {
+        const std::lock_guard<std::mutex> l(pMutex);
+        auto now = std::chrono::steady_clock::now();
+        auto& idle = pIdle[host];
+
+        // Drop the clients whose connection has most likely been closed
+        idle.erase(std::remove_if(idle.begin(), idle.end(),
+                       [&](const IdleClient& c) {
+                           return now - c.lastUsed > kIdleTimeout;
+                       }),
+            idle.end());
+
+        if (!idle.empty()) {
+            auto client = std::move(idle.back().client);
+            idle.pop_back();
+            reused = true;
+            return client;
+        }
+    }
+
+    reused = false;
+    auto client = std::make_unique<httplib::Client>(host);
+    client->set_keep_alive(true);
+    return client;
+}
+
+void HttpClientPool::release(const std::string& host,
+    std::unique_ptr<httplib::Client> client, bool reused,
+    std::chrono::microseconds latency)
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+
+    auto& stats = pStats[host];
+    stats.requests++;
+    if (reused) {
+        stats.handshakesSaved++;
+    }
+    stats.lastLatency = latency;
+    stats.totalLatency += latency;
+    stats.maxLatency = std::max(stats.maxLatency, latency);
+
+    spdlog::trace("HTTP request to {} took {}us ({})", host, latency.count(),
+        reused ? "reused connection" : "new connection");
+
+    auto& idle = pIdle[host];
+    if (idle.size() < kMaxIdlePerHost) {
+        idle.push_back({ std::move(client), std::chrono::steady_clock::now() });
+    }
+}
+}
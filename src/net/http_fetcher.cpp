@@ -0,0 +1,158 @@
+#include "net/http_fetcher.h"
+
+#include <cstdlib>
+#include <spdlog/spdlog.h>
+#include <utility>
+
+namespace vector_audio::net {
+
+HttpFetcher& HttpFetcher::instance()
+{
+    static HttpFetcher fetcher;
+    return fetcher;
+}
+
+FetchStatus HttpFetcher::fetch(
+    const std::string& host, const std::string& path, std::string& body)
+{
+    const auto key = host + path;
+
+    bool haveBody = false;
+    {
+        const std::lock_guard<std::mutex> l(pMutex);
+        auto it = pCache.find(key);
+        haveBody = it != pCache.end() && it->second.body.has_value();
+    }
+
+    std::string received;
+    auto status = this->stream(
+        host, path,
+        [&](const char* data, size_t length) {
+            received.append(data, length);
+            return true;
+        },
+        haveBody);
+
+    const std::lock_guard<std::mutex> l(pMutex);
+    auto it = pCache.find(key);
+
+    if (status == FetchStatus::kOk) {
+        // Only keep a copy if the server gave us something to revalidate with
+        if (it != pCache.end()) {
+            it->second.body = received;
+        }
+        body = std::move(received);
+    } else if (status == FetchStatus::kNotModified) {
+        if (it == pCache.end() || !it->second.body) {
+            return FetchStatus::kError;
+        }
+        body = *it->second.body;
+    }
+
+    return status;
+}
+
+FetchStatus HttpFetcher::stream(const std::string& host,
+    const std::string& path, const httplib::ContentReceiver& receiver,
+    bool conditional)
+{
+    const auto key = host + path;
+
+    httplib::Headers headers = { { "Accept-Encoding", "gzip" } };
+    uint64_t previousSize = 0;
+    if (conditional) {
+        const std::lock_guard<std::mutex> l(pMutex);
+        auto it = pCache.find(key);
+        if (it != pCache.end()) {
+            if (!it->second.etag.empty()) {
+                headers.emplace("If-None-Match", it->second.etag);
+            }
+            if (!it->second.lastModified.empty()) {
+                headers.emplace("If-Modified-Since", it->second.lastModified);
+            }
+            previousSize = it->second.size;
+        }
+    }
+
+    int status = 0;
+    CacheEntry validators;
+    uint64_t wireLength = 0;
+    bool compressed = false;
+    uint64_t decoded = 0;
+
+    auto res = HttpClientPool::instance().with(host, [&](httplib::Client& cli) {
+        return cli.Get(
+            path, headers,
+            [&](const httplib::Response& response) {
+                status = response.status;
+                if (status == 200) {
+                    validators.etag = response.get_header_value("ETag");
+                    validators.lastModified
+                        = response.get_header_value("Last-Modified");
+                    compressed = response.has_header("Content-Encoding");
+                    wireLength = std::strtoull(
+                        response.get_header_value("Content-Length").c_str(),
+                        nullptr, 10);
+                    return true;
+                }
+
+                if (status == 304) {
+                    return true;
+                }
+
+                spdlog::error(
+                    "Couldn't load {}{}, HTTP error {}", host, path, status);
+                return false;
+            },
+            [&](const char* data, size_t length) {
+                decoded += length;
+                return receiver(data, length);
+            });
+    });
+
+    const bool cancelledByReceiver
+        = !res && res.error() == httplib::Error::Canceled && status == 200;
+    if (!res && !cancelledByReceiver) {
+        if (status == 0) {
+            spdlog::error("Could not download URL: {}{}", host, path);
+        }
+        return FetchStatus::kError;
+    }
+
+    const std::lock_guard<std::mutex> l(pMutex);
+    pStats.requests++;
+
+    if (status == 304) {
+        pStats.notModified++;
+        pStats.bytesSaved += previousSize;
+        return FetchStatus::kNotModified;
+    }
+
+    pStats.bytesDecoded += decoded;
+    if (compressed && wireLength > 0) {
+        pStats.bytesReceived += wireLength;
+        if (decoded > wireLength) {
+            pStats.bytesSaved += decoded - wireLength;
+        }
+    } else {
+        pStats.bytesReceived += decoded;
+    }
+
+    // A partial body cannot be revalidated later on
+    if (cancelledByReceiver
+        || (validators.etag.empty() && validators.lastModified.empty())) {
+        pCache.erase(key);
+    } else {
+        validators.size = decoded;
+        pCache[key] = std::move(validators);
+    }
+
+    return FetchStatus::kOk;
+}
+
+HttpFetcher::Stats HttpFetcher::getStats()
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+    return pStats;
+}
+}
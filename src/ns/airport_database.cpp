@@ -0,0 +1,201 @@
+#include "ns/airport_database.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+namespace ns {
+
+std::optional<Airport> AirportDatabase::Tables::find(
+    std::string_view icao) const
+{
+    if (index.isOpen()) {
+        return index.find(icao);
+    }
+
+    auto it = all.find(std::string(icao));
+    if (it == all.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+AirportDatabase::~AirportDatabase()
+{
+    if (pReady.valid()) {
+        pReady.wait();
+    }
+}
+
+void AirportDatabase::loadAsync(std::string indexPath, std::string jsonPath,
+    std::map<std::string, CallsignResolver::Alias> aliases,
+    std::function<void()> onLoaded)
+{
+    pIndexPath = std::move(indexPath);
+    pJsonPath = std::move(jsonPath);
+    pAliases = std::move(aliases);
+    pReady = std::async(
+        std::launch::async, [this, onLoaded = std::move(onLoaded)]() {
+            const bool loaded = load();
+            if (onLoaded) {
+                onLoaded();
+            }
+            return loaded;
+        });
+}
+
+std::shared_ptr<const AirportDatabase::Tables> AirportDatabase::get() const
+{
+    return std::atomic_load(&pTables);
+}
+
+bool AirportDatabase::isLoading() const
+{
+    return pReady.valid()
+        && pReady.wait_for(std::chrono::seconds(0))
+        != std::future_status::ready;
+}
+
+std::optional<Airport> AirportDatabase::find(std::string_view icao) const
+{
+    if (auto tables = this->get()) {
+        return tables->find(icao);
+    }
+
+    // Mapping the index is cheap enough to do for a single lookup
+    AirportIndex index;
+    if (index.open(pIndexPath)) {
+        return index.find(icao);
+    }
+
+    if (auto tables = this->waitForTables()) {
+        return tables->find(icao);
+    }
+    return std::nullopt;
+}
+
+std::optional<Airport> AirportDatabase::resolveCallsign(
+    std::string_view callsign) const
+{
+    if (auto tables = this->get()) {
+        const auto* airport = tables->resolver.resolve(callsign);
+        return airport != nullptr ? std::optional<Airport>(*airport)
+                                  : std::nullopt;
+    }
+
+    return this->find(callsign.substr(0, callsign.find('_')));
+}
+
+std::optional<Airport> AirportDatabase::nearest(
+    double lat, double lon, double maxDistanceKm) const
+{
+    if (auto tables = this->waitForTables()) {
+        return tables->grid.nearest(lat, lon, maxDistanceKm);
+    }
+    return std::nullopt;
+}
+
+std::shared_ptr<const AirportDatabase::Tables>
+AirportDatabase::waitForTables() const
+{
+    if (auto tables = this->get()) {
+        return tables;
+    }
+
+    if (!pReady.valid()
+        || pReady.wait_for(kLookupTimeout) != std::future_status::ready) {
+        spdlog::warn("Airport database is not loaded yet");
+        return nullptr;
+    }
+    return this->get();
+}
+
+bool AirportDatabase::load()
+{
+    // if we cannot load this database, it's not that important, we will just
+    // log it.
+    auto tables = std::make_shared<Tables>();
+    std::vector<Airport> airports;
+
+    // The index is compiled from the json at build time and needs no parsing,
+    // the json is only read if the index is missing or from another version
+    auto t1 = std::chrono::high_resolution_clock::now();
+    if (!this->loadIndex(*tables, airports)) {
+        spdlog::info("Could not map the airport index, falling back to json");
+        if (!this->loadJson(*tables, airports)) {
+            pProgress = 1.0F;
+            return false;
+        }
+    }
+    pProgress = 0.8F;
+
+    tables->resolver.build(airports, pAliases);
+    pProgress = 0.9F;
+    tables->grid.build(std::move(airports));
+
+    auto t2 = std::chrono::high_resolution_clock::now();
+    spdlog::info("Loaded {} airports in {}ms", tables->grid.size(),
+        std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+            .count());
+
+    std::atomic_store(&pTables, std::shared_ptr<const Tables>(tables));
+    pProgress = 1.0F;
+    return true;
+}
+
+bool AirportDatabase::loadIndex(
+    Tables& tables, std::vector<Airport>& airports)
+{
+    if (!tables.index.open(pIndexPath)) {
+        return false;
+    }
+    pProgress = 0.5F;
+
+    airports.reserve(tables.index.size());
+    for (size_t i = 0; i < tables.index.size(); i++) {
+        airports.push_back(tables.index.at(i));
+    }
+    return true;
+}
+
+bool AirportDatabase::loadJson(
+    Tables& tables, std::vector<Airport>& airports)
+{
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(pJsonPath, ec);
+    std::ifstream f(pJsonPath, std::ios::binary);
+    if (ec || !f) {
+        spdlog::warn("Could not find airport database json file");
+        return false;
+    }
+
+    // Read in chunks so that progress can be reported, parsing the whole
+    // buffer afterwards is the slow part
+    constexpr size_t kChunkSize = 256 * 1024;
+    std::string contents;
+    contents.resize(size);
+    size_t read = 0;
+    while (read < size && f) {
+        f.read(contents.data() + read,
+            static_cast<std::streamsize>(std::min(kChunkSize, size - read)));
+        read += static_cast<size_t>(f.gcount());
+        pProgress = 0.3F * static_cast<float>(read) / static_cast<float>(size);
+    }
+    contents.resize(read);
+
+    try {
+        tables.all = Airport::parseDatabase(contents);
+    } catch (nlohmann::json::exception& ex) {
+        spdlog::warn("Could parse airport database: {}", ex.what());
+        return false;
+    }
+
+    airports.reserve(tables.all.size());
+    for (const auto& [icao, airport] : tables.all) {
+        airports.push_back(airport);
+    }
+    return true;
+}
+}
@@ -0,0 +1,136 @@
+#include "ns/airport_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns {
+
+namespace {
+    constexpr double kEarthRadiusKm = 6371.0;
+    constexpr double kPi = 3.14159265358979323846;
+    // Shortest north-south distance covered by one cell
+    constexpr double kCellHeightKm = kEarthRadiusKm * kPi / 180.0;
+
+    double toRadians(double degrees) { return degrees * kPi / 180.0; }
+}
+
+void AirportGrid::build(std::vector<Airport> airports)
+{
+    auto cellOf = [](const Airport& airport) {
+        return latCell(airport.lat) * kLonCells + lonCell(airport.lon);
+    };
+
+    std::sort(airports.begin(), airports.end(),
+        [&](const Airport& a, const Airport& b) {
+            return cellOf(a) < cellOf(b);
+        });
+
+    pCellStart.assign(kLatCells * kLonCells + 1, 0);
+    for (const auto& airport : airports) {
+        pCellStart[cellOf(airport) + 1]++;
+    }
+    for (size_t i = 1; i < pCellStart.size(); i++) {
+        pCellStart[i] += pCellStart[i - 1];
+    }
+
+    pAirports = std::move(airports);
+}
+
+std::optional<Airport> AirportGrid::nearest(
+    double lat, double lon, double maxDistanceKm) const
+{
+    if (this->empty()) {
+        return std::nullopt;
+    }
+
+    const int centerLat = latCell(lat);
+    const int centerLon = lonCell(lon);
+
+    const Airport* best = nullptr;
+    double bestDistance = maxDistanceKm;
+
+    // Scan growing windows of cells around the position, skipping the cells
+    // the previous window covered. Cells narrow towards the poles, so windows
+    // are widened east-west to always reach at least r cell heights away.
+    // Anything outside the window of ring r is then further than r cell
+    // heights, and the search stops once that exceeds the best match.
+    int previousLatRing = -1;
+    int previousLonRing = -1;
+    for (int ring = 0;; ring++) {
+        const double poleward = std::min(std::abs(lat) + ring + 1.0, 90.0);
+        const double lonScale = std::cos(toRadians(poleward));
+        const int lonRing = lonScale * kLonCells / 2 <= ring
+            ? kLonCells / 2
+            : static_cast<int>(std::ceil(ring / lonScale));
+
+        for (int dLat = -ring; dLat <= ring; dLat++) {
+            const int cellLat = centerLat + dLat;
+            if (cellLat < 0 || cellLat >= kLatCells) {
+                continue;
+            }
+
+            for (int dLon = -lonRing; dLon <= lonRing; dLon++) {
+                if (std::abs(dLat) <= previousLatRing
+                    && std::abs(dLon) <= previousLonRing) {
+                    continue;
+                }
+                // Both ends meet on the antimeridian when wrapping all around
+                if (lonRing == kLonCells / 2 && dLon == lonRing) {
+                    continue;
+                }
+
+                const int cellLon
+                    = ((centerLon + dLon) % kLonCells + kLonCells) % kLonCells;
+                const int cell = cellLat * kLonCells + cellLon;
+                for (uint32_t i = pCellStart[cell]; i < pCellStart[cell + 1];
+                     i++) {
+                    const auto& airport = pAirports[i];
+                    const double distance
+                        = distanceKm(lat, lon, airport.lat, airport.lon);
+                    if (distance <= bestDistance) {
+                        bestDistance = distance;
+                        best = &airport;
+                    }
+                }
+            }
+        }
+
+        previousLatRing = ring;
+        previousLonRing = lonRing;
+
+        const bool coversEverything
+            = lonRing == kLonCells / 2 && ring >= kLatCells;
+        if (ring * kCellHeightKm > bestDistance || coversEverything) {
+            break;
+        }
+    }
+
+    if (best == nullptr) {
+        return std::nullopt;
+    }
+    return *best;
+}
+
+double AirportGrid::distanceKm(
+    double lat1, double lon1, double lat2, double lon2)
+{
+    const double dLat = toRadians(lat2 - lat1);
+    const double dLon = toRadians(lon2 - lon1);
+    const double a = std::sin(dLat / 2) * std::sin(dLat / 2)
+        + std::cos(toRadians(lat1)) * std::cos(toRadians(lat2))
+            * std::sin(dLon / 2) * std::sin(dLon / 2);
+    return 2 * kEarthRadiusKm * std::asin(std::min(1.0, std::sqrt(a)));
+}
+
+int AirportGrid::latCell(double lat)
+{
+    return std::clamp(static_cast<int>(std::floor(lat + 90.0)), 0,
+        kLatCells - 1);
+}
+
+int AirportGrid::lonCell(double lon)
+{
+    const int cell = static_cast<int>(std::floor(lon + 180.0));
+    return ((cell % kLonCells) + kLonCells) % kLonCells;
+}
+}
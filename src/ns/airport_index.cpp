@@ -0,0 +1,202 @@
+#include "ns/airport_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ns {
+
+namespace {
+    // Keys are compared as zero padded fixed-width blocks
+    bool makeKey(std::string_view icao, char (&key)[AirportIndex::kKeySize])
+    {
+        if (icao.empty() || icao.size() > AirportIndex::kKeySize) {
+            return false;
+        }
+
+        std::memset(key, 0, sizeof(key));
+        std::memcpy(key, icao.data(), icao.size());
+        return true;
+    }
+}
+
+AirportIndex::~AirportIndex() { this->close(); }
+
+bool AirportIndex::open(const std::string& path)
+{
+    this->close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    pFileHandle = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)
+        || static_cast<size_t>(size.QuadPart) < sizeof(Header)) {
+        this->close();
+        return false;
+    }
+    pMappingSize = static_cast<size_t>(size.QuadPart);
+
+    pMappingHandle
+        = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (pMappingHandle == nullptr) {
+        this->close();
+        return false;
+    }
+
+    pMapping = MapViewOfFile(pMappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (pMapping == nullptr) {
+        this->close();
+        return false;
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0
+        || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+    pMappingSize = static_cast<size_t>(st.st_size);
+
+    void* mapping = mmap(nullptr, pMappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (mapping == MAP_FAILED) {
+        pMappingSize = 0;
+        return false;
+    }
+    pMapping = mapping;
+#endif
+
+    Header header {};
+    std::memcpy(&header, pMapping, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0
+        || header.version != kVersion || header.byteOrder != 1
+        || pMappingSize < sizeof(Header) + header.count * sizeof(Record)) {
+        this->close();
+        return false;
+    }
+
+    pRecords = reinterpret_cast<const Record*>(
+        static_cast<const char*>(pMapping) + sizeof(Header));
+    pCount = header.count;
+    return true;
+}
+
+void AirportIndex::close()
+{
+#ifdef _WIN32
+    if (pMapping != nullptr) {
+        UnmapViewOfFile(pMapping);
+    }
+    if (pMappingHandle != nullptr) {
+        CloseHandle(pMappingHandle);
+    }
+    if (pFileHandle != nullptr) {
+        CloseHandle(pFileHandle);
+    }
+    pMappingHandle = nullptr;
+    pFileHandle = nullptr;
+#else
+    if (pMapping != nullptr) {
+        munmap(const_cast<void*>(pMapping), pMappingSize);
+    }
+#endif
+
+    pMapping = nullptr;
+    pMappingSize = 0;
+    pRecords = nullptr;
+    pCount = 0;
+}
+
+std::optional<Airport> AirportIndex::find(std::string_view icao) const
+{
+    char key[kKeySize];
+    if (!this->isOpen() || !makeKey(icao, key)) {
+        return std::nullopt;
+    }
+
+    const auto* end = pRecords + pCount;
+    const auto* it = std::lower_bound(
+        pRecords, end, key, [](const Record& record, const char* k) {
+            return std::memcmp(record.icao, k, kKeySize) < 0;
+        });
+
+    if (it == end || std::memcmp(it->icao, key, kKeySize) != 0) {
+        return std::nullopt;
+    }
+
+    return toAirport(*it);
+}
+
+int AirportIndex::write(
+    const std::string& path, const std::map<std::string, Airport>& airports)
+{
+    std::vector<Record> records;
+    records.reserve(airports.size());
+    for (const auto& [icao, airport] : airports) {
+        Record record {};
+        if (!makeKey(icao, record.icao)) {
+            continue;
+        }
+        if (airport.iata.size() <= kIataSize) {
+            std::memcpy(record.iata, airport.iata.data(), airport.iata.size());
+        }
+        record.latitudeE6
+            = static_cast<int32_t>(std::lround(airport.lat * 1e6));
+        record.longitudeE6
+            = static_cast<int32_t>(std::lround(airport.lon * 1e6));
+        record.elevation = airport.elevation;
+        records.push_back(record);
+    }
+
+    std::sort(records.begin(), records.end(),
+        [](const Record& a, const Record& b) {
+            return std::memcmp(a.icao, b.icao, kKeySize) < 0;
+        });
+
+    Header header {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = 1;
+    header.count = static_cast<uint32_t>(records.size());
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(records.data()),
+        static_cast<std::streamsize>(records.size() * sizeof(Record)));
+
+    return out ? static_cast<int>(records.size()) : -1;
+}
+
+Airport AirportIndex::toAirport(const Record& record)
+{
+    Airport airport;
+    airport.icao.assign(record.icao, strnlen(record.icao, kKeySize));
+    airport.iata.assign(record.iata, strnlen(record.iata, kIataSize));
+    airport.lat = record.latitudeE6 / 1e6;
+    airport.lon = record.longitudeE6 / 1e6;
+    airport.elevation = record.elevation;
+    return airport;
+}
+}
@@ -0,0 +1,137 @@
+#include "ns/callsign_resolver.h"
+
+#include <spdlog/spdlog.h>
+#include <unordered_map>
+
+namespace ns {
+
+std::map<std::string, CallsignResolver::Alias>
+CallsignResolver::aliasesFromConfig(const toml::value& config)
+{
+    std::map<std::string, Alias> aliases;
+    if (!config.is_table() || !config.contains("airport_aliases")) {
+        return aliases;
+    }
+
+    const auto& section = config.at("airport_aliases");
+    if (!section.is_table()) {
+        spdlog::warn("[airport_aliases] must be a table, ignoring it");
+        return aliases;
+    }
+
+    for (const auto& [key, value] : section.as_table()) {
+        try {
+            Alias alias;
+            if (value.is_string()) {
+                alias.airport = value.as_string();
+            } else {
+                Airport point;
+                point.icao = key;
+                point.lat = toml::find<double>(value, "lat");
+                point.lon = toml::find<double>(value, "lon");
+                point.elevation = toml::find_or<int>(value, "elevation", 0);
+                alias.point = point;
+            }
+            aliases.emplace(key, alias);
+        } catch (const std::exception& ex) {
+            spdlog::warn("Ignoring airport alias {}: {}", key, ex.what());
+        }
+    }
+
+    return aliases;
+}
+
+void CallsignResolver::build(const std::vector<Airport>& airports,
+    const std::map<std::string, Alias>& aliases)
+{
+    pNodes.assign(1, Node {});
+    pTargets.clear();
+    pTargets.reserve(airports.size() + aliases.size());
+
+    std::unordered_map<std::string_view, int32_t> byIcao;
+    byIcao.reserve(airports.size());
+
+    // Later inserts overwrite earlier ones, hence the precedence order
+    for (const auto& airport : airports) {
+        pTargets.push_back(airport);
+    }
+    for (size_t i = 0; i < pTargets.size(); i++) {
+        if (!pTargets[i].iata.empty()) {
+            this->insert(pTargets[i].iata, static_cast<int32_t>(i));
+        }
+    }
+    for (size_t i = 0; i < pTargets.size(); i++) {
+        this->insert(pTargets[i].icao, static_cast<int32_t>(i));
+        byIcao.emplace(pTargets[i].icao, static_cast<int32_t>(i));
+    }
+
+    for (const auto& [key, alias] : aliases) {
+        if (alias.point) {
+            pTargets.push_back(*alias.point);
+            this->insert(key, static_cast<int32_t>(pTargets.size() - 1));
+            continue;
+        }
+
+        auto it = byIcao.find(alias.airport);
+        if (it == byIcao.end()) {
+            spdlog::warn("Airport alias {} points at unknown airport {}", key,
+                alias.airport);
+            continue;
+        }
+        this->insert(key, it->second);
+    }
+}
+
+const Airport* CallsignResolver::resolve(std::string_view callsign) const
+{
+    if (pNodes.empty()) {
+        return nullptr;
+    }
+
+    int32_t best = -1;
+    int32_t node = 0;
+    for (size_t i = 0; i < callsign.size(); i++) {
+        node = this->child(node, callsign[i]);
+        if (node < 0) {
+            break;
+        }
+
+        const bool atBoundary
+            = i + 1 == callsign.size() || callsign[i + 1] == '_';
+        if (atBoundary && pNodes[node].target >= 0) {
+            best = pNodes[node].target;
+        }
+    }
+
+    return best >= 0 ? &pTargets[best] : nullptr;
+}
+
+void CallsignResolver::insert(std::string_view key, int32_t target)
+{
+    int32_t node = 0;
+    for (char c : key) {
+        int32_t next = this->child(node, c);
+        if (next < 0) {
+            next = static_cast<int32_t>(pNodes.size());
+            Node created;
+            created.c = c;
+            created.nextSibling = pNodes[node].firstChild;
+            pNodes.push_back(created);
+            pNodes[node].firstChild = next;
+        }
+        node = next;
+    }
+    pNodes[node].target = target;
+}
+
+int32_t CallsignResolver::child(int32_t node, char c) const
+{
+    for (int32_t it = pNodes[node].firstChild; it >= 0;
+         it = pNodes[it].nextSibling) {
+        if (pNodes[it].c == c) {
+            return it;
+        }
+    }
+    return -1;
+}
+}
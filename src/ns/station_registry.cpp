@@ -0,0 +1,159 @@
+#include "ns/station_registry.h"
+
+namespace ns {
+
+std::optional<StationRegistry::Handle> StationRegistry::add(Station station)
+{
+    Handle handle = 0;
+    {
+        const std::unique_lock<std::shared_mutex> lock(pMutex);
+        if (pByFrequency.count(station.getFrequencyHz()) > 0) {
+            return std::nullopt;
+        }
+
+        handle = pNextHandle++;
+        pByFrequency.emplace(station.getFrequencyHz(), handle);
+        pByCallsign.emplace(station.getCallsign(), handle);
+        pStations.emplace(handle, station);
+    }
+
+    this->notify(Change::kAdded, station);
+    return handle;
+}
+
+bool StationRegistry::remove(Handle handle)
+{
+    std::optional<Station> removed;
+    {
+        const std::unique_lock<std::shared_mutex> lock(pMutex);
+        auto it = pStations.find(handle);
+        if (it == pStations.end()) {
+            return false;
+        }
+        removed = it->second;
+        this->eraseLocked(it);
+    }
+
+    this->notify(Change::kRemoved, *removed);
+    return true;
+}
+
+bool StationRegistry::removeByFrequency(int frequencyHz)
+{
+    Handle handle = 0;
+    {
+        const std::shared_lock<std::shared_mutex> lock(pMutex);
+        auto it = pByFrequency.find(frequencyHz);
+        if (it == pByFrequency.end()) {
+            return false;
+        }
+        handle = it->second;
+    }
+    return this->remove(handle);
+}
+
+std::vector<Station> StationRegistry::clear()
+{
+    std::vector<Station> removed;
+    {
+        const std::unique_lock<std::shared_mutex> lock(pMutex);
+        removed.reserve(pStations.size());
+        for (auto& [handle, station] : pStations) {
+            removed.push_back(std::move(station));
+        }
+        pStations.clear();
+        pByFrequency.clear();
+        pByCallsign.clear();
+    }
+
+    for (const auto& station : removed) {
+        this->notify(Change::kRemoved, station);
+    }
+    return removed;
+}
+
+void StationRegistry::setTransceiverCount(
+    const std::string& callsign, int count)
+{
+    std::vector<Station> updated;
+    {
+        const std::unique_lock<std::shared_mutex> lock(pMutex);
+        auto [begin, end] = pByCallsign.equal_range(callsign);
+        for (auto it = begin; it != end; ++it) {
+            auto& station = pStations.at(it->second);
+            station.setTransceiverCount(count);
+            updated.push_back(station);
+        }
+    }
+
+    for (const auto& station : updated) {
+        this->notify(Change::kUpdated, station);
+    }
+}
+
+bool StationRegistry::hasFrequency(int frequencyHz) const
+{
+    const std::shared_lock<std::shared_mutex> lock(pMutex);
+    return pByFrequency.count(frequencyHz) > 0;
+}
+
+std::optional<Station> StationRegistry::findByFrequency(int frequencyHz) const
+{
+    const std::shared_lock<std::shared_mutex> lock(pMutex);
+    auto it = pByFrequency.find(frequencyHz);
+    if (it == pByFrequency.end()) {
+        return std::nullopt;
+    }
+    return pStations.at(it->second);
+}
+
+bool StationRegistry::empty() const
+{
+    const std::shared_lock<std::shared_mutex> lock(pMutex);
+    return pStations.empty();
+}
+
+size_t StationRegistry::size() const
+{
+    const std::shared_lock<std::shared_mutex> lock(pMutex);
+    return pStations.size();
+}
+
+int StationRegistry::subscribe(Listener listener)
+{
+    const std::lock_guard<std::mutex> lock(pListenersMutex);
+    const int id = pNextListenerId++;
+    pListeners.emplace(id, std::move(listener));
+    return id;
+}
+
+void StationRegistry::unsubscribe(int id)
+{
+    const std::lock_guard<std::mutex> lock(pListenersMutex);
+    pListeners.erase(id);
+}
+
+void StationRegistry::eraseLocked(std::map<Handle, Station>::iterator it)
+{
+    const Handle handle = it->first;
+    pByFrequency.erase(it->second.getFrequencyHz());
+
+    auto [begin, end] = pByCallsign.equal_range(it->second.getCallsign());
+    for (auto c = begin; c != end; ++c) {
+        if (c->second == handle) {
+            pByCallsign.erase(c);
+            break;
+        }
+    }
+
+    pStations.erase(it);
+}
+
+void StationRegistry::notify(Change change, const Station& station)
+{
+    const std::lock_guard<std::mutex> lock(pListenersMutex);
+    for (const auto& [id, listener] : pListeners) {
+        listener(change, station);
+    }
+}
+}
@@ -0,0 +1,105 @@
+#include "sdk/frequencyStateTracker.h"
+
+#include "sdk/sdkWebsocketMessage.h"
+
+#include <utility>
+#include <vector>
+
+namespace vector_audio::sdk {
+
+namespace {
+    using StationMap = std::map<int, ns::Station>;
+
+    bool sameStation(const ns::Station& a, const ns::Station& b)
+    {
+        return a.getFrequencyHz() == b.getFrequencyHz()
+            && a.getCallsign() == b.getCallsign();
+    }
+
+    // Fills the added and removed stations, returns whether there are any
+    bool diff(
+        const StationMap& before, const StationMap& after, nlohmann::json& out)
+    {
+        std::vector<ns::Station> added;
+        std::vector<ns::Station> removed;
+
+        for (const auto& [frequency, station] : after) {
+            auto it = before.find(frequency);
+            if (it == before.end()) {
+                added.push_back(station);
+            } else if (!sameStation(it->second, station)) {
+                removed.push_back(it->second);
+                added.push_back(station);
+            }
+        }
+        for (const auto& [frequency, station] : before) {
+            if (after.find(frequency) == after.end()) {
+                removed.push_back(station);
+            }
+        }
+
+        const bool changed = !added.empty() || !removed.empty();
+        out["added"] = std::move(added);
+        out["removed"] = std::move(removed);
+        return changed;
+    }
+
+    std::vector<ns::Station> toList(const StationMap& stations)
+    {
+        std::vector<ns::Station> out;
+        out.reserve(stations.size());
+        for (const auto& [frequency, station] : stations) {
+            out.push_back(station);
+        }
+        return out;
+    }
+}
+
+FrequencyStateTracker::State FrequencyStateTracker::capture(
+    const ns::StationRegistry& stations, const afv::RadioStateCache& radioState)
+{
+    State state;
+    stations.forEach([&](auto /*handle*/, const ns::Station& s) {
+        const auto radio = radioState.get(s.getFrequencyHz());
+        if (radio.rx) {
+            state.rx.emplace(s.getFrequencyHz(), s);
+        }
+        if (radio.tx) {
+            state.tx.emplace(s.getFrequencyHz(), s);
+        }
+        if (radio.xc) {
+            state.xc.emplace(s.getFrequencyHz(), s);
+        }
+    });
+    return state;
+}
+
+std::optional<nlohmann::json> FrequencyStateTracker::update(State current)
+{
+    nlohmann::json jsonMessage = types::WebsocketMessage::buildMessage(
+        types::WebsocketMessageType::kFrequencyStateDelta);
+
+    auto& value = jsonMessage["value"];
+    bool changed = diff(pLast.rx, current.rx, value["rx"]);
+    changed = diff(pLast.tx, current.tx, value["tx"]) || changed;
+    changed = diff(pLast.xc, current.xc, value["xc"]) || changed;
+    if (!changed) {
+        return std::nullopt;
+    }
+
+    pLast = std::move(current);
+    value["seq"] = ++pSequence;
+    return jsonMessage;
+}
+
+nlohmann::json FrequencyStateTracker::fullMessage() const
+{
+    nlohmann::json jsonMessage = types::WebsocketMessage::buildMessage(
+        types::WebsocketMessageType::kFrequencyStateUpdate);
+    jsonMessage["value"]["seq"] = pSequence;
+    jsonMessage["value"]["rx"] = toList(pLast.rx);
+    jsonMessage["value"]["tx"] = toList(pLast.tx);
+    jsonMessage["value"]["xc"] = toList(pLast.xc);
+    return jsonMessage;
+}
+}
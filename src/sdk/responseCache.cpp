@@ -0,0 +1,62 @@
+#include "sdk/responseCache.h"
+
+#include <cstdio>
+
+namespace vector_audio::sdk {
+
+namespace {
+    uint64_t fnv1a(std::string_view data)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (const char c : data) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    std::string_view trim(std::string_view value)
+    {
+        const auto first = value.find_first_not_of(" \t");
+        if (first == std::string_view::npos) {
+            return {};
+        }
+        const auto last = value.find_last_not_of(" \t");
+        return value.substr(first, last - first + 1);
+    }
+}
+
+std::shared_ptr<const CachedBody> CachedBody::make(
+    const CacheKey& key, std::string body)
+{
+    auto cached = std::make_shared<CachedBody>();
+    cached->key = key;
+
+    char etag[24];
+    std::snprintf(etag, sizeof(etag), "\"%016llx\"",
+        static_cast<unsigned long long>(fnv1a(body)));
+    cached->etag = etag;
+    cached->body = std::move(body);
+    return cached;
+}
+
+bool etagMatches(std::string_view ifNoneMatch, std::string_view etag)
+{
+    while (!ifNoneMatch.empty()) {
+        const auto comma = ifNoneMatch.find(',');
+        auto candidate = trim(ifNoneMatch.substr(0, comma));
+        // Weak comparison, as If-None-Match requires
+        if (candidate.substr(0, 2) == "W/") {
+            candidate.remove_prefix(2);
+        }
+        if (candidate == "*" || candidate == etag) {
+            return true;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        ifNoneMatch.remove_prefix(comma + 1);
+    }
+    return false;
+}
+}
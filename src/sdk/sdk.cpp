@@ -2,20 +2,44 @@
 
 namespace vector_audio {
 
-SDK::SDK(const std::shared_ptr<afv_native::api::atcClient>& clientPtr)
+SDK::SDK(const std::shared_ptr<afv_native::api::atcClient>& clientPtr,
+    std::shared_ptr<afv::RadioStateCache> radioState)
+    : pRadioState(std::move(radioState))
 {
     this->pClient = clientPtr;
+
+    // Removing a station can change which frequencies are active
+    this->pStationListener = shared::stations.subscribe(
+        [this](ns::StationRegistry::Change change, const ns::Station&) {
+            this->pStationsVersion++;
+            if (change == ns::StationRegistry::Change::kRemoved) {
+                this->handleAFVEventForWebsocket(
+                    sdk::types::Event::kFrequencyStateUpdate, std::nullopt,
+                    std::nullopt);
+            }
+        });
+
+    this->pEventThread = std::thread(&SDK::runEventLoop, this);
 }
 
 SDK::~SDK()
 {
-    for (auto [id, ws] : this->pWsRegistry) {
-        ws->shutdown();
-        ws.reset();
+    {
+        const std::lock_guard<std::mutex> lock(this->pEventMutex);
+        this->pStopEvents = true;
+    }
+    this->pEventCondition.notify_one();
+    if (this->pEventThread.joinable()) {
+        this->pEventThread.join();
+    }
+
+    shared::stations.unsubscribe(this->pStationListener);
+    this->pWebsockets.closeAll();
+    // Not set if the server failed to start
+    if (this->pSDKServer) {
+        this->pSDKServer->stop();
+        this->pSDKServer.reset();
     }
-    this->pWsRegistry.clear();
-    this->pSDKServer->stop();
-    this->pSDKServer.reset();
     this->pRouter.reset();
 }
 
@@ -32,29 +56,222 @@ bool SDK::start()
     return false;
 }
 
-void SDK::loopCleanup(const std::vector<std::string>& liveReceivedCallsigns)
+void SDK::queueClientEvent(afv::ClientEvent event)
+{
+    if (this->pClientEvents.push(std::move(event))) {
+        this->pEventCondition.notify_one();
+    }
+}
+
+bool SDK::wantsClientEvent(afv_native::ClientEventType type)
+{
+    using afv_native::ClientEventType;
+
+    switch (type) {
+    case ClientEventType::APIServerDisconnected:
+    case ClientEventType::VoiceServerConnected:
+    case ClientEventType::VoiceServerDisconnected:
+    case ClientEventType::PttOpen:
+    case ClientEventType::PttClosed:
+    case ClientEventType::RxOpen:
+    case ClientEventType::RxClosed:
+    case ClientEventType::PilotRxOpen:
+    case ClientEventType::PilotRxClosed:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void SDK::runEventLoop()
+{
+    uint64_t radioStateVersion = this->pRadioState->getVersion();
+
+    while (true) {
+        this->pClientEvents.drain([this](const afv::ClientEvent& event) {
+            this->handleClientEvent(event);
+        });
+        this->pWebsockets.sweep(std::chrono::steady_clock::now());
+
+        const auto overflows = this->pClientEvents.overflows();
+        if (overflows != this->pReportedOverflows) {
+            spdlog::warn(
+                "SDK dropped {} afv RX and PTT events, its queue was full",
+                overflows - this->pReportedOverflows);
+            this->pReportedOverflows = overflows;
+
+            // The radio state follows these events, it may have missed some
+            this->pRadioState->invalidateAll();
+        }
+
+        // Catches the changes nobody asked to broadcast, an unchanged state
+        // sends nothing
+        const auto version = this->pRadioState->getVersion();
+        if (version != radioStateVersion) {
+            radioStateVersion = version;
+            this->scheduleFrequencyStateUpdate();
+        }
+
+        std::unique_lock<std::mutex> lock(this->pEventMutex);
+        if (this->pStopEvents) {
+            return;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (this->pFrequencyStateDue && now >= *this->pFrequencyStateDue) {
+            this->pFrequencyStateDue.reset();
+            lock.unlock();
+            this->broadcastFrequencyStateChanges();
+            continue;
+        }
+
+        auto wakeAt = now + kEventWaitTimeout;
+        if (this->pFrequencyStateDue && *this->pFrequencyStateDue < wakeAt) {
+            wakeAt = *this->pFrequencyStateDue;
+        }
+        // The producers notify without the lock, a notification racing with
+        // this check is picked up at the timeout
+        this->pEventCondition.wait_until(lock, wakeAt, [this] {
+            return this->pStopEvents || this->pClientEvents.depth() > 0;
+        });
+    }
+}
+
+void SDK::scheduleFrequencyStateUpdate()
 {
-    // Clear out the old API data every 500ms
-    auto currentTime = std::chrono::high_resolution_clock::now();
-    if (std::chrono::duration_cast<std::chrono::milliseconds>(
-            currentTime - shared::currentlyTransmittingApiTimer)
-            .count()
-        < 300) {
+    {
+        const std::lock_guard<std::mutex> lock(this->pEventMutex);
+        if (this->pFrequencyStateDue) {
+            return;
+        }
+        this->pFrequencyStateDue
+            = std::chrono::steady_clock::now() + kFrequencyStateCoalesceWindow;
+    }
+    this->pEventCondition.notify_one();
+}
+
+void SDK::broadcastFrequencyStateChanges()
+{
+    if (!this->pSDKServer) {
+        return;
+    }
+
+    // Without voice every station is gone, clients get them as removed.
+    // Captured before taking the lock, the registry must not be read under it
+    const bool connected = this->pClient->IsVoiceConnected();
+    auto current = connected ? sdk::FrequencyStateTracker::capture(
+                                   shared::stations, *this->pRadioState)
+                             : sdk::FrequencyStateTracker::State {};
+
+    const std::lock_guard<std::mutex> lock(this->pFrequencyStateMutex);
+    auto delta = this->pFrequencyState.update(std::move(current));
+
+    // Clients that connected while voice was down have no state to apply a
+    // delta to
+    const bool reconnected = connected && !this->pFrequencyStateConnected;
+    this->pFrequencyStateConnected = connected;
+    if (!reconnected && !delta) {
         return;
     }
 
-    const std::lock_guard<std::mutex> lock(shared::transmittingMutex);
-    shared::currentlyTransmittingApiData
-        = absl::StrJoin(liveReceivedCallsigns, ",");
+    using Audience = sdk::WebsocketRegistry::Audience;
+    using Delivery = sdk::WebsocketRegistry::Delivery;
+
+    // Deltas are opt-in, other clients only understand the full state
+    const auto full = this->pFrequencyState.fullMessage().dump();
+    if (reconnected) {
+        this->pWebsockets.broadcast(
+            full, Delivery::kLatestWins, Audience::kEveryone);
+    } else {
+        this->pWebsockets.broadcast(
+            full, Delivery::kLatestWins, Audience::kFullState);
+        this->pWebsockets.broadcast(
+            delta->dump(), Delivery::kDroppable, Audience::kDeltas);
+    }
+}
 
-    shared::currentlyTransmittingApiTimer = currentTime;
+void SDK::addWebsocketClient(
+    const restinio::websocket::basic::ws_handle_t& wsh)
+{
+    {
+        // No broadcast can get between the two, so the full state is the
+        // first frequency message the client gets
+        const std::lock_guard<std::mutex> lock(this->pFrequencyStateMutex);
+        this->pWebsockets.add(wsh);
+        this->queueFullFrequencyState(wsh->connection_id());
+    }
+
+    // Any change not broadcast yet follows
+    this->scheduleFrequencyStateUpdate();
+}
+
+void SDK::subscribeToFrequencyDeltas(uint64_t connectionId)
+{
+    const std::lock_guard<std::mutex> lock(this->pFrequencyStateMutex);
+    this->pWebsockets.subscribeDeltas(connectionId);
+    // The base the next delta applies to
+    this->queueFullFrequencyState(connectionId);
+}
+
+void SDK::sendFullFrequencyState(uint64_t connectionId)
+{
+    const std::lock_guard<std::mutex> lock(this->pFrequencyStateMutex);
+    this->queueFullFrequencyState(connectionId);
+}
+
+void SDK::queueFullFrequencyState(uint64_t connectionId)
+{
+    // Sent once voice connects
+    if (!this->pFrequencyStateConnected) {
+        return;
+    }
+    this->pWebsockets.send(connectionId,
+        this->pFrequencyState.fullMessage().dump(),
+        sdk::WebsocketRegistry::Delivery::kLatestWins);
+}
+
+void SDK::handleClientEvent(const afv::ClientEvent& event)
+{
+    this->pRadioState->handleEvent(event);
+
+    if (event.type == afv_native::ClientEventType::VoiceServerConnected
+        || event.type == afv_native::ClientEventType::VoiceServerDisconnected) {
+        this->scheduleFrequencyStateUpdate();
+    }
+
+    // Bug in that this applies to RX to all station types, including ATC,
+    // not only pilots
+    if ((event.type == afv_native::ClientEventType::PilotRxOpen
+            || event.type == afv_native::ClientEventType::PilotRxClosed)
+        && !event.text.empty()) {
+        const bool open
+            = event.type == afv_native::ClientEventType::PilotRxOpen;
+        spdlog::debug(
+            "Pilot {} {} RX", event.text, open ? "opened" : "closed");
+        this->handleAFVEventForWebsocket(
+            open ? sdk::types::Event::kRxBegin : sdk::types::Event::kRxEnd,
+            event.text, event.frequencyHz);
+    }
+}
+
+void SDK::publishTransmitting(
+    const std::vector<std::string>& liveReceivedCallsigns)
+{
+    if (liveReceivedCallsigns == this->pLastTransmitting) {
+        return;
+    }
+
+    this->pLastTransmitting = liveReceivedCallsigns;
+    this->pTransmittingResponse.publish({ ++this->pTransmittingVersion, 0, 0 },
+        absl::StrJoin(liveReceivedCallsigns, ","));
 }
 
 void SDK::buildServer()
 {
     this->buildRouter();
 
-    pSDKServer = restinio::run_async<>(restinio::own_io_context(),
+    pSDKServer = restinio::run_async<>(
+        restinio::external_io_context(this->pIoContext),
         restinio::server_settings_t<serverTraits> {}
             .port(shared::apiServerPort)
             .address("0.0.0.0")
@@ -66,6 +283,12 @@ void SDK::handleAFVEventForWebsocket(sdk::types::Event event,
     const std::optional<std::string>& callsign,
     const std::optional<int>& frequencyHz)
 {
+    // Also scheduled while disconnected, clients must see the stations go
+    if (event == sdk::types::Event::kFrequencyStateUpdate) {
+        this->scheduleFrequencyStateUpdate();
+        return;
+    }
+
     if (!this->pSDKServer || !this->pClient->IsVoiceConnected()) {
         return;
     }
@@ -75,7 +298,10 @@ void SDK::handleAFVEventForWebsocket(sdk::types::Event event,
             = WebsocketMessage::buildMessage(WebsocketMessageType::kRxBegin);
         jsonMessage["value"]["callsign"] = *callsign;
         jsonMessage["value"]["pFrequencyHz"] = *frequencyHz;
-        this->broadcastOnWebsocket(jsonMessage.dump());
+        // RX events carry no sequence number, a lost kRxEnd would never be
+        // corrected
+        this->broadcastOnWebsocket(jsonMessage.dump(),
+            sdk::WebsocketRegistry::Delivery::kReliable);
         return;
     }
 
@@ -84,45 +310,8 @@ void SDK::handleAFVEventForWebsocket(sdk::types::Event event,
             = WebsocketMessage::buildMessage(WebsocketMessageType::kRxEnd);
         jsonMessage["value"]["callsign"] = *callsign;
         jsonMessage["value"]["pFrequencyHz"] = *frequencyHz;
-        this->broadcastOnWebsocket(jsonMessage.dump());
-        return;
-    }
-
-    if (event == sdk::types::Event::kFrequencyStateUpdate) {
-        nlohmann::json jsonMessage = WebsocketMessage::buildMessage(
-            WebsocketMessageType::kFrequencyStateUpdate);
-
-        // std::lock_guard<std::mutex> lock(shared::fetchedStationMutex);
-        // Lock needed outside of this function due to it being called somewhere
-        // where the mutex is already locked
-
-        std::vector<ns::Station> rxBar;
-        for (const auto& s : shared::fetchedStations) {
-            if (pClient->GetRxState(s.getFrequencyHz())) {
-                rxBar.push_back(s);
-            }
-        }
-
-        std::vector<ns::Station> txBar;
-        for (const auto& s : shared::fetchedStations) {
-            if (pClient->GetTxState(s.getFrequencyHz())) {
-                txBar.push_back(s);
-            }
-        }
-
-        std::vector<ns::Station> xcBar;
-        for (const auto& s : shared::fetchedStations) {
-            if (pClient->GetXcState(s.getFrequencyHz())) {
-                xcBar.push_back(s);
-            }
-        }
-
-        jsonMessage["value"]["rx"] = std::move(rxBar);
-        jsonMessage["value"]["tx"] = std::move(txBar);
-        jsonMessage["value"]["xc"] = std::move(xcBar);
-
-        this->broadcastOnWebsocket(jsonMessage.dump());
-
+        this->broadcastOnWebsocket(jsonMessage.dump(),
+            sdk::WebsocketRegistry::Delivery::kReliable);
         return;
     }
 };
@@ -133,7 +322,7 @@ void SDK::buildRouter()
 
     this->pRouter->http_get(
         mSDKCallUrl[sdkCall::kTransmitting], [&](auto req, auto /*params*/) {
-            return SDK::handleTransmittingSDKCall(req);
+            return this->handleTransmittingSDKCall(req);
         });
 
     this->pRouter->http_get(mSDKCallUrl[sdkCall::kRx],
@@ -163,54 +352,45 @@ void SDK::buildRouter()
 restinio::request_handling_status_t SDK::handleTransmittingSDKCall(
     const restinio::request_handle_t& req)
 {
-    const std::lock_guard<std::mutex> lock(shared::transmittingMutex);
-    return req->create_response()
-        .set_body(shared::currentlyTransmittingApiData)
-        .done();
+    return respondCached(req, this->pTransmittingResponse.get());
 };
 
 restinio::request_handling_status_t SDK::handleRxSDKCall(
     const restinio::request_handle_t& req)
 {
-    if (!pClient->IsVoiceConnected()) {
-        return req->create_response().set_body("").done();
-    }
-
-    std::lock_guard<std::mutex> lock(shared::fetchedStationMutex);
-
-    std::string out;
-    for (const auto& f : shared::fetchedStations) {
-        if (!pClient->GetRxState(f.getFrequencyHz())) {
-            continue;
-        }
-        out += f.getCallsign() + ":" + f.getHumanFrequency() + ",";
-    }
-
-    if (!out.empty()) {
-        if (out.back() == ',') {
-            out.pop_back();
-        }
-    }
-
-    return req->create_response().set_body(out).done();
+    return respondCached(req,
+        this->pRxResponse.get(this->stationStateKey(),
+            [this] { return this->buildStationList(false); }));
 };
 
 restinio::request_handling_status_t SDK::handleTxSDKCall(
     const restinio::request_handle_t& req)
+{
+    return respondCached(req,
+        this->pTxResponse.get(this->stationStateKey(),
+            [this] { return this->buildStationList(true); }));
+}
+
+sdk::CacheKey SDK::stationStateKey() const
+{
+    return { this->pRadioState->getVersion(), this->pStationsVersion.load(),
+        this->pClient->IsVoiceConnected() ? 1U : 0U };
+}
+
+std::string SDK::buildStationList(bool tx) const
 {
     if (!pClient->IsVoiceConnected()) {
-        return req->create_response().set_body("").done();
+        return "";
     }
 
-    std::lock_guard<std::mutex> lock(shared::fetchedStationMutex);
-
     std::string out;
-    for (const auto& f : shared::fetchedStations) {
-        if (!pClient->GetTxState(f.getFrequencyHz())) {
-            continue;
+    shared::stations.forEach([&](auto /*handle*/, const ns::Station& f) {
+        const auto radio = pRadioState->get(f.getFrequencyHz());
+        if (!(tx ? radio.tx : radio.rx)) {
+            return;
         }
         out += f.getCallsign() + ":" + f.getHumanFrequency() + ",";
-    }
+    });
 
     if (!out.empty()) {
         if (out.back() == ',') {
@@ -218,7 +398,25 @@ restinio::request_handling_status_t SDK::handleTxSDKCall(
         }
     }
 
-    return req->create_response().set_body(out).done();
+    return out;
+}
+
+restinio::request_handling_status_t SDK::respondCached(
+    const restinio::request_handle_t& req,
+    const std::shared_ptr<const sdk::CachedBody>& body)
+{
+    const auto ifNoneMatch = req->header().get_field_or(
+        restinio::http_field_t::if_none_match, std::string());
+    if (sdk::etagMatches(ifNoneMatch, body->etag)) {
+        return req->create_response(restinio::status_not_modified())
+            .append_header(restinio::http_field_t::etag, body->etag)
+            .done();
+    }
+
+    return req->create_response()
+        .append_header(restinio::http_field_t::etag, body->etag)
+        .set_body(body->body)
+        .done();
 }
 
 restinio::request_handling_status_t SDK::handleWebSocketSDKCall(
@@ -231,7 +429,9 @@ restinio::request_handling_status_t SDK::handleWebSocketSDKCall(
 
     auto wsh = restinio::websocket::basic::upgrade<serverTraits>(*req,
         restinio::websocket::basic::activation_t::immediate,
-        [&](auto wsh, auto m) {
+        [this](auto wsh, auto m) {
+            this->pWebsockets.touch(wsh->connection_id());
+
             if (restinio::websocket::basic::opcode_t::ping_frame
                 == m->opcode()) {
                 // Ping-Pong
@@ -243,37 +443,38 @@ restinio::request_handling_status_t SDK::handleWebSocketSDKCall(
                            connection_close_frame
                 == m->opcode()) {
                 // Close connection
-                this->pWsRegistry.erase(wsh->connection_id());
+                this->pWebsockets.remove(wsh->connection_id());
+            } else if (restinio::websocket::basic::opcode_t::text_frame
+                == m->opcode()) {
+                const auto request
+                    = nlohmann::json::parse(m->payload(), nullptr, false);
+                const auto type = !request.is_discarded() && request.is_object()
+                    ? request.value("type", std::string())
+                    : std::string();
+                const auto& types = sdk::types::kWebsocketMessageTypeMap;
+                if (type
+                    == types.at(WebsocketMessageType::kFrequencyStateResync)) {
+                    // A client that missed a sequence number asks for
+                    // everything
+                    this->sendFullFrequencyState(wsh->connection_id());
+                } else if (type
+                    == types.at(WebsocketMessageType::
+                            kFrequencyStateSubscribeDeltas)) {
+                    this->subscribeToFrequencyDeltas(wsh->connection_id());
+                }
             }
         });
 
-    // Store websocket connection
-    this->pWsRegistry.emplace(wsh->connection_id(), wsh);
-
-    // Upon connection, send the status of frequencies straight away
-    {
-        std::lock_guard<std::mutex> lock(shared::fetchedStationMutex);
-        this->handleAFVEventForWebsocket(
-            sdk::types::Event::kFrequencyStateUpdate, std::nullopt,
-            std::nullopt);
-    }
+    // Store websocket connection, and send the status of frequencies
+    // straight away
+    this->addWebsocketClient(wsh);
 
     return restinio::request_accepted();
 };
 
-void SDK::broadcastOnWebsocket(const std::string& data)
+void SDK::broadcastOnWebsocket(
+    std::string data, sdk::WebsocketRegistry::Delivery delivery)
 {
-    restinio::websocket::basic::message_t outgoingMessage;
-    outgoingMessage.set_opcode(
-        restinio::websocket::basic::opcode_t::text_frame);
-    outgoingMessage.set_payload(data);
-
-    for (auto& [id, ws] : this->pWsRegistry) {
-        try {
-            ws->send_message(outgoingMessage);
-        } catch (const std::exception& ex) {
-            spdlog::error("Failed to send data to websocket: {}", ex.what());
-        }
-    }
+    this->pWebsockets.broadcast(std::move(data), delivery);
 };
 }
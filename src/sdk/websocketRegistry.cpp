@@ -0,0 +1,305 @@
+#include "sdk/websocketRegistry.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace vector_audio::sdk {
+
+namespace {
+    constexpr std::chrono::seconds kSweepInterval { 1 };
+}
+
+WebsocketRegistry::WebsocketRegistry(restinio::asio_ns::io_context& ioContext)
+    : pIoContext(ioContext)
+{
+}
+
+void WebsocketRegistry::add(const restinio::websocket::basic::ws_handle_t& wsh)
+{
+    auto client = std::make_shared<Client>();
+    client->id = wsh->connection_id();
+    client->wsh = wsh;
+    client->lastSeen = std::chrono::steady_clock::now();
+    client->lastPing = client->lastSeen;
+
+    const std::lock_guard<std::mutex> lock(pMutex);
+    pClients[client->id] = std::move(client);
+}
+
+void WebsocketRegistry::remove(uint64_t id)
+{
+    const std::lock_guard<std::mutex> lock(pMutex);
+    pClients.erase(id);
+}
+
+void WebsocketRegistry::touch(uint64_t id)
+{
+    auto client = this->find(id);
+    if (!client) {
+        return;
+    }
+
+    const std::lock_guard<std::mutex> lock(client->mutex);
+    client->lastSeen = std::chrono::steady_clock::now();
+}
+
+void WebsocketRegistry::subscribeDeltas(uint64_t id)
+{
+    if (auto client = this->find(id)) {
+        client->wantsDeltas = true;
+    }
+}
+
+void WebsocketRegistry::send(
+    uint64_t id, std::string payload, Delivery delivery)
+{
+    auto client = this->find(id);
+    if (!client) {
+        return;
+    }
+
+    this->enqueue(client,
+        { restinio::websocket::basic::opcode_t::text_frame,
+            std::make_shared<const std::string>(std::move(payload)),
+            delivery });
+}
+
+void WebsocketRegistry::broadcast(
+    std::string payload, Delivery delivery, Audience audience)
+{
+    std::vector<std::shared_ptr<Client>> clients;
+    {
+        const std::lock_guard<std::mutex> lock(pMutex);
+        clients.reserve(pClients.size());
+        for (const auto& [id, client] : pClients) {
+            if (audience == Audience::kEveryone
+                || client->wantsDeltas == (audience == Audience::kDeltas)) {
+                clients.push_back(client);
+            }
+        }
+    }
+    if (clients.empty()) {
+        return;
+    }
+
+    const Message message { restinio::websocket::basic::opcode_t::text_frame,
+        std::make_shared<const std::string>(std::move(payload)), delivery };
+    for (const auto& client : clients) {
+        this->enqueue(client, message);
+    }
+}
+
+void WebsocketRegistry::sweep(std::chrono::steady_clock::time_point now)
+{
+    std::vector<std::shared_ptr<Client>> clients;
+    {
+        const std::lock_guard<std::mutex> lock(pMutex);
+        if (now - pLastSweep < kSweepInterval) {
+            return;
+        }
+        pLastSweep = now;
+
+        const auto dropped = pDropped.load();
+        if (dropped != pReportedDropped) {
+            spdlog::warn("Dropped {} websocket messages, a client is not "
+                         "keeping up",
+                dropped - pReportedDropped);
+            pReportedDropped = dropped;
+        }
+
+        for (const auto& [id, client] : pClients) {
+            clients.push_back(client);
+        }
+    }
+
+    for (const auto& client : clients) {
+        bool ping = false;
+        {
+            const std::lock_guard<std::mutex> lock(client->mutex);
+            if (now - client->lastSeen > kIdleTimeout) {
+                spdlog::info("Websocket client {} timed out", client->id);
+            } else if (now - client->lastSeen >= kPingInterval
+                && now - client->lastPing >= kPingInterval) {
+                client->lastPing = now;
+                ping = true;
+            } else {
+                continue;
+            }
+        }
+
+        if (ping) {
+            this->enqueue(client,
+                { restinio::websocket::basic::opcode_t::ping_frame,
+                    std::make_shared<const std::string>(),
+                    Delivery::kDroppable });
+        } else {
+            this->evict(client->id);
+        }
+    }
+}
+
+void WebsocketRegistry::closeAll()
+{
+    std::map<uint64_t, std::shared_ptr<Client>> clients;
+    {
+        const std::lock_guard<std::mutex> lock(pMutex);
+        clients.swap(pClients);
+    }
+
+    for (const auto& [id, client] : clients) {
+        client->wsh->shutdown();
+    }
+}
+
+WebsocketRegistry::Stats WebsocketRegistry::getStats() const
+{
+    Stats stats;
+    {
+        const std::lock_guard<std::mutex> lock(pMutex);
+        stats.clients = pClients.size();
+    }
+    stats.dropped = pDropped.load();
+    stats.evicted = pEvicted.load();
+    return stats;
+}
+
+std::shared_ptr<WebsocketRegistry::Client> WebsocketRegistry::find(
+    uint64_t id) const
+{
+    const std::lock_guard<std::mutex> lock(pMutex);
+    auto it = pClients.find(id);
+    return it != pClients.end() ? it->second : nullptr;
+}
+
+void WebsocketRegistry::enqueue(
+    const std::shared_ptr<Client>& client, Message message)
+{
+    bool stalled = false;
+    {
+        const std::lock_guard<std::mutex> lock(client->mutex);
+        auto& queue = client->queue;
+        if (message.delivery == Delivery::kLatestWins) {
+            queue.erase(std::remove_if(queue.begin(), queue.end(),
+                            [](const Message& queued) {
+                                return queued.delivery == Delivery::kLatestWins;
+                            }),
+                queue.end());
+        }
+
+        if (queue.size() >= kMaxQueuedMessages) {
+            auto oldest = std::find_if(
+                queue.begin(), queue.end(), [](const Message& queued) {
+                    return queued.delivery == Delivery::kDroppable;
+                });
+            if (oldest != queue.end()) {
+                queue.erase(oldest);
+                pDropped++;
+            } else if (message.delivery == Delivery::kDroppable) {
+                pDropped++;
+                return;
+            } else {
+                // Only messages that cannot be dropped are queued and the
+                // writes are not completing, the client stopped reading
+                queue.clear();
+                stalled = true;
+            }
+        }
+
+        if (!stalled) {
+            queue.push_back(std::move(message));
+            if (client->flushing || client->inFlight >= kMaxInFlight) {
+                return;
+            }
+            client->flushing = true;
+        }
+    }
+
+    if (stalled) {
+        spdlog::warn("Websocket client {} is not reading, disconnecting it",
+            client->id);
+        this->evict(client->id);
+        return;
+    }
+
+    restinio::asio_ns::post(
+        pIoContext, [this, client] { this->flush(client); });
+}
+
+void WebsocketRegistry::flush(const std::shared_ptr<Client>& client)
+{
+    while (true) {
+        Message queued;
+        {
+            const std::lock_guard<std::mutex> lock(client->mutex);
+            if (client->queue.empty() || client->inFlight >= kMaxInFlight) {
+                client->flushing = false;
+                return;
+            }
+            queued = std::move(client->queue.front());
+            client->queue.pop_front();
+            client->inFlight++;
+        }
+
+        restinio::websocket::basic::message_t message;
+        message.set_opcode(queued.opcode);
+        message.set_payload(*queued.payload);
+        try {
+            client->wsh->send_message(message,
+                [this, client](const restinio::asio_ns::error_code& ec) {
+                    this->writeCompleted(client, ec);
+                });
+        } catch (const std::exception& ex) {
+            spdlog::error("Failed to send data to websocket: {}", ex.what());
+            this->evict(client->id);
+
+            const std::lock_guard<std::mutex> lock(client->mutex);
+            client->queue.clear();
+            client->flushing = false;
+            return;
+        }
+    }
+}
+
+void WebsocketRegistry::writeCompleted(const std::shared_ptr<Client>& client,
+    const restinio::asio_ns::error_code& ec)
+{
+    if (ec) {
+        spdlog::debug("Websocket write to client {} failed: {}", client->id,
+            ec.message());
+        this->evict(client->id);
+        return;
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock(client->mutex);
+        client->inFlight--;
+        if (client->flushing || client->queue.empty()) {
+            return;
+        }
+        client->flushing = true;
+    }
+
+    restinio::asio_ns::post(
+        pIoContext, [this, client] { this->flush(client); });
+}
+
+void WebsocketRegistry::evict(uint64_t id)
+{
+    std::shared_ptr<Client> client;
+    {
+        const std::lock_guard<std::mutex> lock(pMutex);
+        auto it = pClients.find(id);
+        if (it == pClients.end()) {
+            return;
+        }
+        client = std::move(it->second);
+        pClients.erase(it);
+    }
+
+    pEvicted++;
+    client->wsh->kill();
+}
+}
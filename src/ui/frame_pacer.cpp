@@ -0,0 +1,70 @@
+#include "ui/frame_pacer.h"
+
+#include <algorithm>
+
+namespace vector_audio::ui {
+
+namespace {
+    constexpr float kSmoothing = 0.1F;
+
+    float toMs(FramePacer::Clock::duration d)
+    {
+        return std::chrono::duration<float, std::milli>(d).count();
+    }
+}
+
+void FramePacer::wake()
+{
+    {
+        const std::lock_guard<std::mutex> l(pMutex);
+        pWoken = true;
+        pActiveUntil = Clock::now() + kActivityLinger;
+    }
+    pWakeCondition.notify_one();
+}
+
+void FramePacer::setContinuous(bool continuous) { pContinuous = continuous; }
+
+bool FramePacer::waitForFrame()
+{
+    std::unique_lock<std::mutex> l(pMutex);
+
+    auto now = Clock::now();
+    const bool active = pContinuous || now < pActiveUntil;
+    pStats.idle = !active;
+
+    const auto due = pLastFrame
+        + (active ? std::chrono::duration_cast<Clock::duration>(
+                        kActiveFrameInterval)
+                  : std::chrono::duration_cast<Clock::duration>(
+                        kIdleFrameInterval));
+    if (now >= due) {
+        pLastFrame = now;
+        return true;
+    }
+
+    pWakeCondition.wait_until(
+        l, std::min(due, now + kEventPollInterval), [this] { return pWoken; });
+
+    // The caller polls its events and comes back, at which point the frame
+    // is drawn if the wake up made it due
+    pWoken = false;
+    return false;
+}
+
+void FramePacer::frameDrawn(Clock::duration cpu, Clock::duration gpu)
+{
+    pStats.cpuMs += (toMs(cpu) - pStats.cpuMs) * kSmoothing;
+    pStats.gpuMs += (toMs(gpu) - pStats.gpuMs) * kSmoothing;
+
+    pStatsWindowFrames++;
+    const auto now = Clock::now();
+    const auto elapsed = now - pStatsWindowStart;
+    if (elapsed >= std::chrono::seconds(1)) {
+        pStats.framesPerSecond = static_cast<float>(pStatsWindowFrames)
+            / std::chrono::duration<float>(elapsed).count();
+        pStatsWindowFrames = 0;
+        pStatsWindowStart = now;
+    }
+}
+}
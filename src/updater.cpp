@@ -9,10 +9,9 @@ namespace vector_audio {
 // This class is blocking on purpose, we want to update if needed before
 // anything
 Updater::Updater()
-    : pCli(pBaseUrl)
 {
     // Check version file
-    auto res = pCli.Get(pVersionUrl);
+    auto res = net::HttpClientPool::instance().get(pBaseUrl, pVersionUrl);
     if (!res) {
         spdlog::critical(
             "Cannot access updater endpoint, please update manually!");
@@ -46,9 +45,10 @@ Updater::Updater()
     }
 
     // isBetaAvailable
-    auto betaRes = pCli.Get(pBetaVersionUrl);
+    auto betaRes
+        = net::HttpClientPool::instance().get(pBaseUrl, pBetaVersionUrl);
 
-    if (res->status != 200) {
+    if (!betaRes || betaRes->status != 200) {
         spdlog::warn("Cannot access updater beta endpoint!");
         return;
     }
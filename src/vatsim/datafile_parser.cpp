@@ -0,0 +1,257 @@
+#include "vatsim/datafile_parser.h"
+
+#include <nlohmann/json.hpp>
+#include <utility>
+
+namespace vector_audio::vatsim {
+
+namespace {
+    // Only records the scalar fields found directly inside the element,
+    // nested objects such as flight_plan are walked over and ignored
+    class RecordSax : public nlohmann::json_sax<nlohmann::json> {
+    public:
+        explicit RecordSax(DatafileRecord& record)
+            : pRecord(record)
+        {
+        }
+
+        bool null() override { return true; }
+        bool boolean(bool /*val*/) override { return true; }
+
+        bool number_integer(number_integer_t val) override
+        {
+            setNumber(static_cast<double>(val));
+            return true;
+        }
+
+        bool number_unsigned(number_unsigned_t val) override
+        {
+            setNumber(static_cast<double>(val));
+            return true;
+        }
+
+        bool number_float(number_float_t val, const string_t& /*s*/) override
+        {
+            setNumber(val);
+            return true;
+        }
+
+        bool string(string_t& val) override
+        {
+            if (pDepth != 1) {
+                return true;
+            }
+
+            if (pKey == "callsign") {
+                pRecord.callsign = std::move(val);
+            } else if (pKey == "frequency") {
+                pRecord.frequency = std::move(val);
+            }
+            return true;
+        }
+
+        bool binary(binary_t& /*val*/) override { return true; }
+
+        bool start_object(std::size_t /*elements*/) override
+        {
+            pDepth++;
+            return true;
+        }
+
+        bool end_object() override
+        {
+            pDepth--;
+            return true;
+        }
+
+        bool start_array(std::size_t /*elements*/) override
+        {
+            pDepth++;
+            return true;
+        }
+
+        bool end_array() override
+        {
+            pDepth--;
+            return true;
+        }
+
+        bool key(string_t& val) override
+        {
+            if (pDepth == 1) {
+                pKey = std::move(val);
+            }
+            return true;
+        }
+
+        bool parse_error(std::size_t /*position*/,
+            const std::string& /*last_token*/,
+            const nlohmann::detail::exception& /*ex*/) override
+        {
+            return false;
+        }
+
+    private:
+        DatafileRecord& pRecord;
+        int pDepth = 0;
+        std::string pKey;
+
+        void setNumber(double val)
+        {
+            if (pDepth != 1) {
+                return;
+            }
+
+            if (pKey == "cid") {
+                pRecord.cid = static_cast<int>(val);
+            } else if (pKey == "facility") {
+                pRecord.facility = static_cast<int>(val);
+            } else if (pKey == "latitude") {
+                pRecord.latitude = val;
+            } else if (pKey == "longitude") {
+                pRecord.longitude = val;
+            }
+        }
+    };
+}
+
+DatafileStreamParser::DatafileStreamParser(
+    std::initializer_list<Section> sections, ElementHandler handler)
+    : pHandler(std::move(handler))
+{
+    for (const auto& section : sections) {
+        pWanted[static_cast<size_t>(section)] = true;
+    }
+}
+
+DatafileStreamParser::Section DatafileStreamParser::sectionForKey(
+    const std::string& key)
+{
+    if (key == "general") {
+        return Section::kGeneral;
+    }
+
+    if (key == "pilots") {
+        return Section::kPilots;
+    }
+
+    if (key == "controllers") {
+        return Section::kControllers;
+    }
+
+    return Section::kOther;
+}
+
+bool DatafileStreamParser::feed(const char* data, size_t length)
+{
+    if (pStopped || pComplete || pMalformed) {
+        return false;
+    }
+
+    auto t1 = std::chrono::steady_clock::now();
+
+    size_t captureFrom = 0;
+    size_t i = 0;
+    for (; i < length; i++) {
+        const char c = data[i];
+
+        if (pInString) {
+            if (pEscape) {
+                pEscape = false;
+                if (pReadingKey) {
+                    pKey.push_back(c);
+                }
+            } else if (c == '\\') {
+                pEscape = true;
+            } else if (c == '"') {
+                pInString = false;
+                if (pReadingKey) {
+                    pReadingKey = false;
+                    pSection = sectionForKey(pKey);
+                }
+            } else if (pReadingKey) {
+                pKey.push_back(c);
+            }
+            continue;
+        }
+
+        switch (c) {
+        case '"':
+            pInString = true;
+            if (pDepth == 1 && pExpectKey) {
+                pExpectKey = false;
+                pReadingKey = true;
+                pKey.clear();
+            }
+            break;
+
+        case '{':
+        case '[':
+            pDepth++;
+            if (pDepth == 1) {
+                pExpectKey = true;
+                if (c != '{') {
+                    pMalformed = true;
+                }
+            } else if (!pCapturing && c == '{' && isWanted(pSection)
+                && ((pDepth == 2 && pSection == Section::kGeneral)
+                    || (pDepth == 3 && pSection != Section::kGeneral))) {
+                pCapturing = true;
+                pCaptureDepth = pDepth;
+                captureFrom = i;
+            }
+            break;
+
+        case '}':
+        case ']':
+            if (pCapturing && pDepth == pCaptureDepth) {
+                pCapturing = false;
+                pElement.append(data + captureFrom, i - captureFrom + 1);
+                if (!pHandler(pSection, pElement)) {
+                    pStopped = true;
+                }
+                pElement.clear();
+            }
+
+            pDepth--;
+            if (pDepth == 0) {
+                pComplete = true;
+            } else if (pDepth < 0) {
+                pMalformed = true;
+            }
+            break;
+
+        case ',':
+            if (pDepth == 1) {
+                pExpectKey = true;
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        if (pStopped || pComplete || pMalformed) {
+            i++;
+            break;
+        }
+    }
+
+    pBytesScanned += i;
+    if (pCapturing) {
+        pElement.append(data + captureFrom, length - captureFrom);
+    }
+
+    pParseTime += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - t1);
+
+    return !pStopped && !pComplete && !pMalformed;
+}
+
+bool DatafileStreamParser::parseRecord(
+    std::string_view element, DatafileRecord& out)
+{
+    RecordSax sax(out);
+    return nlohmann::json::sax_parse(element.begin(), element.end(), &sax);
+}
+}
@@ -0,0 +1,114 @@
+#include "vatsim/datafile_snapshot.h"
+
+#include <nlohmann/json.hpp>
+#include <utility>
+
+namespace vector_audio::vatsim {
+
+DatafileSnapshot::DatafileSnapshot(Clock::duration ttl, bool withPilots)
+    : pFetchedAt(Clock::now())
+    , pTtl(ttl)
+    , pIndex(std::make_shared<Index>())
+{
+    pIndex->withPilots = withPilots;
+}
+
+std::shared_ptr<const DatafileSnapshot> DatafileSnapshot::renewed() const
+{
+    auto copy = std::make_shared<DatafileSnapshot>(*this);
+    copy->pFetchedAt = Clock::now();
+    return copy;
+}
+
+void DatafileSnapshot::setControllersComplete(bool complete)
+{
+    pIndex->controllersComplete = complete;
+}
+
+bool DatafileSnapshot::covers(int cid, bool withPilots) const
+{
+    if (withPilots && !pIndex->withPilots) {
+        return false;
+    }
+
+    // A scan that stopped early only has the entries up to the one it was
+    // looking for
+    return pIndex->controllersComplete || findControllerByCid(cid) != nullptr;
+}
+
+bool DatafileSnapshot::addElement(
+    DatafileStreamParser::Section section, std::string_view element)
+{
+    using Section = DatafileStreamParser::Section;
+
+    if (section == Section::kGeneral) {
+        // The general block is tiny, a DOM is fine here
+        auto general = nlohmann::json::parse(element, nullptr, false);
+        if (!general.is_discarded() && general.contains("update_timestamp")
+            && general["update_timestamp"].is_string()) {
+            pIndex->updateTimestamp
+                = general["update_timestamp"].get<std::string>();
+        }
+        return true;
+    }
+
+    DatafileRecord record;
+    if (!DatafileStreamParser::parseRecord(element, record)) {
+        return true; // Skip the odd broken entry rather than the whole file
+    }
+
+    auto& index = *pIndex;
+    if (section == Section::kPilots) {
+        index.pilotsByCallsign.emplace(record.callsign, index.pilots.size());
+        index.pilotsByCid.emplace(record.cid, index.pilots.size());
+        index.pilots.push_back(std::move(record));
+    } else if (section == Section::kControllers) {
+        index.controllersByCallsign.emplace(
+            record.callsign, index.controllers.size());
+        index.controllersByCid.emplace(record.cid, index.controllers.size());
+        index.controllers.push_back(std::move(record));
+    }
+
+    return true;
+}
+
+const DatafileRecord* DatafileSnapshot::findPilot(
+    const std::string& callsign) const
+{
+    return find(pIndex->pilots, pIndex->pilotsByCallsign, callsign);
+}
+
+const DatafileRecord* DatafileSnapshot::findPilotByCid(int cid) const
+{
+    return find(pIndex->pilots, pIndex->pilotsByCid, cid);
+}
+
+const DatafileRecord* DatafileSnapshot::findController(
+    const std::string& callsign) const
+{
+    return find(
+        pIndex->controllers, pIndex->controllersByCallsign, callsign);
+}
+
+const DatafileRecord* DatafileSnapshot::findControllerByCid(int cid) const
+{
+    return find(pIndex->controllers, pIndex->controllersByCid, cid);
+}
+
+const DatafileRecord* DatafileSnapshot::find(
+    const std::vector<DatafileRecord>& list,
+    const std::unordered_map<std::string, size_t>& index,
+    const std::string& key)
+{
+    auto it = index.find(key);
+    return it == index.end() ? nullptr : &list[it->second];
+}
+
+const DatafileRecord* DatafileSnapshot::find(
+    const std::vector<DatafileRecord>& list,
+    const std::unordered_map<int, size_t>& index, int key)
+{
+    auto it = index.find(key);
+    return it == index.end() ? nullptr : &list[it->second];
+}
+}
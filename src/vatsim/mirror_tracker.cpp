@@ -0,0 +1,232 @@
+#include "vatsim/mirror_tracker.h"
+
+#include "net/http_client_pool.h"
+
+#include <algorithm>
+#include <future>
+#include <spdlog/spdlog.h>
+#include <utility>
+
+namespace vector_audio::vatsim {
+
+void MirrorTracker::setMirrors(std::vector<Mirror> mirrors)
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+
+    std::vector<Entry> entries;
+    entries.reserve(mirrors.size());
+    for (auto& mirror : mirrors) {
+        if (auto* known = this->find(mirror)) {
+            entries.push_back(*known);
+        } else {
+            entries.push_back({ std::move(mirror), std::nullopt, 0.0, false });
+        }
+    }
+
+    pEntries = std::move(entries);
+}
+
+void MirrorTracker::probeAll()
+{
+    std::vector<Mirror> mirrors;
+    {
+        const std::lock_guard<std::mutex> l(pMutex);
+        pLastProbe = Clock::now();
+        for (const auto& entry : pEntries) {
+            mirrors.push_back(entry.mirror);
+        }
+    }
+
+    std::vector<std::future<std::optional<std::chrono::milliseconds>>> probes;
+    probes.reserve(mirrors.size());
+    for (const auto& mirror : mirrors) {
+        probes.push_back(std::async(std::launch::async,
+            [mirror]() -> std::optional<std::chrono::milliseconds> {
+                auto t1 = Clock::now();
+                auto status = net::HttpClientPool::instance().with(
+                    mirror.host, [&](httplib::Client& cli) {
+                        cli.set_connection_timeout(kProbeTimeout);
+                        cli.set_read_timeout(kProbeTimeout);
+
+                        auto head = cli.Head(mirror.path);
+                        int headStatus = head ? head->status : 0;
+
+                        // Not every server implements HEAD, ask for a single
+                        // byte instead and hang up once the headers are in
+                        if (headStatus == 405 || headStatus == 501) {
+                            cli.Get(
+                                mirror.path, { { "Range", "bytes=0-0" } },
+                                [&](const httplib::Response& response) {
+                                    headStatus = response.status;
+                                    return false;
+                                },
+                                [](const char*, size_t) { return false; });
+                        }
+
+                        // The client goes back to the pool, where downloads
+                        // expect the default timeouts
+                        cli.set_connection_timeout(
+                            CPPHTTPLIB_CONNECTION_TIMEOUT_SECOND);
+                        cli.set_read_timeout(CPPHTTPLIB_READ_TIMEOUT_SECOND);
+                        return headStatus;
+                    });
+
+                if (status != 200 && status != 206) {
+                    return std::nullopt;
+                }
+
+                return std::chrono::duration_cast<std::chrono::milliseconds>(
+                    Clock::now() - t1);
+            }));
+    }
+
+    for (size_t i = 0; i < mirrors.size(); i++) {
+        auto latency = probes[i].get();
+        if (latency) {
+            spdlog::debug("Datafile mirror {} answered in {}ms",
+                mirrors[i].host, latency->count());
+            this->recordSuccess(mirrors[i], latency);
+        } else {
+            spdlog::warn("Datafile mirror {} did not answer", mirrors[i].host);
+            this->recordFailure(mirrors[i]);
+        }
+    }
+}
+
+bool MirrorTracker::isProbeDue() const
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+    return !pEntries.empty()
+        && (!pLastProbe || Clock::now() - *pLastProbe > kProbeInterval);
+}
+
+bool MirrorTracker::hasReachableMirror() const
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+    return std::any_of(pEntries.begin(), pEntries.end(),
+        [](const Entry& entry) { return entry.reachable; });
+}
+
+std::optional<Mirror> MirrorTracker::current() const
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+    const auto* entry = this->best();
+    if (entry == nullptr) {
+        return std::nullopt;
+    }
+    return entry->mirror;
+}
+
+std::vector<Mirror> MirrorTracker::ranked() const
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+
+    std::vector<const Entry*> entries;
+    entries.reserve(pEntries.size());
+    for (const auto& entry : pEntries) {
+        entries.push_back(&entry);
+    }
+    std::stable_sort(entries.begin(), entries.end(),
+        [](const Entry* a, const Entry* b) { return score(*a) < score(*b); });
+
+    std::vector<Mirror> mirrors;
+    mirrors.reserve(entries.size());
+    for (const auto* entry : entries) {
+        mirrors.push_back(entry->mirror);
+    }
+    return mirrors;
+}
+
+void MirrorTracker::recordSuccess(
+    const Mirror& mirror, std::optional<std::chrono::milliseconds> latency)
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+    auto* entry = this->find(mirror);
+    if (entry == nullptr) {
+        return;
+    }
+
+    entry->reachable = true;
+    entry->errorRate *= 1.0 - kAlpha;
+    if (latency) {
+        auto sample = static_cast<double>(latency->count());
+        entry->latencyMs = entry->latencyMs
+            ? kAlpha * sample + (1.0 - kAlpha) * *entry->latencyMs
+            : sample;
+    }
+}
+
+void MirrorTracker::recordFailure(const Mirror& mirror)
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+    auto* entry = this->find(mirror);
+    if (entry == nullptr) {
+        return;
+    }
+
+    entry->reachable = false;
+
+    const bool wasHealthy = isHealthy(*entry);
+    entry->errorRate = kAlpha + (1.0 - kAlpha) * entry->errorRate;
+    if (wasHealthy && !isHealthy(*entry)) {
+        spdlog::warn("Datafile mirror {} is unhealthy, failing over",
+            mirror.host);
+    }
+}
+
+std::vector<MirrorTracker::Health> MirrorTracker::getHealth() const
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+    const auto* currentEntry = this->best();
+
+    std::vector<Health> health;
+    health.reserve(pEntries.size());
+    for (const auto& entry : pEntries) {
+        Health h;
+        h.host = entry.mirror.host;
+        if (entry.latencyMs) {
+            h.latency = std::chrono::milliseconds(
+                static_cast<int64_t>(*entry.latencyMs));
+        }
+        h.errorRate = entry.errorRate;
+        h.healthy = isHealthy(entry);
+        h.current = &entry == currentEntry;
+        health.push_back(std::move(h));
+    }
+
+    return health;
+}
+
+const MirrorTracker::Entry* MirrorTracker::best() const
+{
+    const Entry* best = nullptr;
+    for (const auto& entry : pEntries) {
+        if (best == nullptr || score(entry) < score(*best)) {
+            best = &entry;
+        }
+    }
+
+    return best;
+}
+
+std::pair<int, double> MirrorTracker::score(const Entry& entry)
+{
+    // Unhealthy mirrors are only used if nothing else is left, and unprobed
+    // ones come after the mirrors we know to be fast
+    if (!isHealthy(entry)) {
+        return { 2, entry.errorRate };
+    }
+    return entry.latencyMs ? std::make_pair(0, *entry.latencyMs)
+                           : std::make_pair(1, entry.errorRate);
+}
+
+MirrorTracker::Entry* MirrorTracker::find(const Mirror& mirror)
+{
+    for (auto& entry : pEntries) {
+        if (entry.mirror == mirror) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+}
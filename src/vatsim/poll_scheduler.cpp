@@ -0,0 +1,68 @@
+#include "vatsim/poll_scheduler.h"
+
+#include <algorithm>
+
+namespace vector_audio::vatsim {
+
+PollScheduler::PollScheduler()
+    : pRng(std::random_device {}())
+    , pNextPollAt(Clock::now())
+{
+}
+
+void PollScheduler::requestFastPolling(int polls)
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+    pFastPollsLeft = std::max(pFastPollsLeft, polls);
+}
+
+PollScheduler::Clock::duration PollScheduler::schedule(
+    Outcome outcome, Clock::duration floor)
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+
+    Clock::duration interval;
+    if (outcome == Outcome::kError) {
+        pFailures++;
+        interval = backoff();
+    } else {
+        pFailures = 0;
+
+        if (pFastPollsLeft > 0) {
+            pFastPollsLeft--;
+            interval = kFastInterval;
+        } else if (outcome == Outcome::kConnected) {
+            interval = kConnectedInterval;
+        } else {
+            interval = pFocused ? kIdleInterval : kUnfocusedInterval;
+        }
+    }
+
+    pInterval = std::max(interval, floor);
+    pNextPollAt = Clock::now() + pInterval;
+    return pInterval;
+}
+
+PollScheduler::Clock::duration PollScheduler::getInterval() const
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+    return pInterval;
+}
+
+PollScheduler::Clock::time_point PollScheduler::getNextPollAt() const
+{
+    const std::lock_guard<std::mutex> l(pMutex);
+    return pNextPollAt;
+}
+
+PollScheduler::Clock::duration PollScheduler::backoff()
+{
+    // Caller holds pMutex
+    const int exponent = std::min(pFailures - 1, 4);
+    auto base = std::min<Clock::duration>(
+        kConnectedInterval * (1 << exponent), kMaxBackoff);
+
+    std::uniform_real_distribution<double> jitter(1.0 - kJitter, 1.0 + kJitter);
+    return std::chrono::duration_cast<Clock::duration>(base * jitter(pRng));
+}
+}
@@ -0,0 +1,97 @@
+#include "vatsim/slurper_parser.h"
+
+#include <cstdlib>
+
+namespace vector_audio::vatsim {
+
+bool SlurperParser::nextLine(std::string_view& data, std::string_view& line)
+{
+    if (data.empty()) {
+        return false;
+    }
+
+    auto end = data.find('\n');
+    if (end == std::string_view::npos) {
+        line = data;
+        data = {};
+    } else {
+        line = data.substr(0, end);
+        data.remove_prefix(end + 1);
+    }
+
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+
+    return true;
+}
+
+bool SlurperParser::splitLine(std::string_view line, SlurperEntry& out)
+{
+    std::array<std::string_view, kMinFields> fields;
+
+    size_t count = 0;
+    while (count < kMinFields) {
+        auto end = line.find(',');
+        fields[count++] = line.substr(0, end);
+
+        if (end == std::string_view::npos) {
+            break;
+        }
+        line.remove_prefix(end + 1);
+    }
+
+    if (count < kMinFields) {
+        return false;
+    }
+
+    out.cid = fields[0];
+    out.callsign = fields[1];
+    out.type = fields[2];
+    out.frequency = fields[3];
+    out.facility = fields[4];
+    out.latitude = fields[5];
+    out.longitude = fields[6];
+
+    return true;
+}
+
+bool SlurperParser::parseFrequencyKhz(std::string_view field, int& out)
+{
+    if (field.empty()) {
+        return false;
+    }
+
+    int value = 0;
+    for (const char c : field) {
+        if (c == '.') {
+            continue;
+        }
+
+        if (c < '0' || c > '9' || value > 100000000) {
+            return false;
+        }
+        value = value * 10 + (c - '0');
+    }
+
+    out = value;
+    return true;
+}
+
+bool SlurperParser::parseDouble(std::string_view field, double& out)
+{
+    // Floating point from_chars is not available on every toolchain we build
+    // with, so we go through strtod with a stack copy instead
+    char buffer[32];
+    if (field.empty() || field.size() >= sizeof(buffer)) {
+        return false;
+    }
+
+    field.copy(buffer, field.size());
+    buffer[field.size()] = '\0';
+
+    char* end = nullptr;
+    out = std::strtod(buffer, &end);
+    return end == buffer + field.size();
+}
+}
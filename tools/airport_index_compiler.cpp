@@ -0,0 +1,44 @@
+// Compiles airports.json into the binary index that VectorAudio maps at
+// startup, see ns::AirportIndex. Run as part of the build:
+//
+//   airport_index_compiler resources/airports.json resources/airports.bin
+
+#include "ns/airport_index.h"
+
+#include <cstdio>
+#include <exception>
+#include <fstream>
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s airports.json airports.bin\n", argv[0]);
+        return 1;
+    }
+
+    std::map<std::string, ns::Airport> airports;
+    try {
+        std::ifstream in(argv[1]);
+        airports = ns::Airport::parseDatabase(in);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "could not parse %s: %s\n", argv[1], e.what());
+        return 1;
+    }
+
+    const int written = ns::AirportIndex::write(argv[2], airports);
+    if (written < 0) {
+        std::fprintf(stderr, "could not write %s\n", argv[2]);
+        return 1;
+    }
+
+    // Check the index reads back before anything ships it
+    ns::AirportIndex index;
+    if (!index.open(argv[2]) || index.size() != static_cast<size_t>(written)) {
+        std::fprintf(stderr, "%s does not read back\n", argv[2]);
+        return 1;
+    }
+
+    std::printf("Indexed %d of %zu airports into %s\n", written,
+        airports.size(), argv[2]);
+    return 0;
+}
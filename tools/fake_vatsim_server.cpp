@@ -0,0 +1,343 @@
+// Local stand-in for the VATSIM status, slurper and datafile endpoints, used
+// to exercise the data handler on a machine without network access.
+//
+// Point VectorAudio at it through the config file:
+//
+//   [endpoints]
+//   status_host = "http://127.0.0.1:8080"
+//   slurper_host = "http://127.0.0.1:8080"
+//
+// and run it with a scenario file:
+//
+//   fake_vatsim_server scenario.json [port]
+//
+// {
+//   "cid": 1234567,
+//   "callsign": "LFPG_TWR",
+//   "frequency": "118.650",
+//   "facility": 4,
+//   "latitude": 49.0,
+//   "longitude": 2.5,
+//   "mirrors": 2,
+//   "latency_ms": 50,
+//   "error_rate": 0.0,
+//   "slurper_down": false,
+//   "timeline": [
+//     { "at": 0, "connected": false },
+//     { "at": 20, "connected": true },
+//     { "at": 120, "connected": false },
+//     { "at": 60, "mirror_down": 0 },
+//     { "at": 90, "mirror_up": 0 },
+//     { "at": 150, "slurper_down": true },
+//     { "at": 180, "latency_ms": 3000 }
+//   ]
+// }
+//
+// Every state change and every request is logged with the time since start,
+// so detection latency and polling cost can be read from the output.
+
+#include <httplib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Scenario {
+    int cid = 1234567;
+    std::string callsign = "LFPG_TWR";
+    std::string frequency = "118.650";
+    int facility = 4;
+    double latitude = 49.0;
+    double longitude = 2.5;
+    int mirrors = 1;
+    int latencyMs = 0;
+    double errorRate = 0.0;
+    bool slurperDown = false;
+    nlohmann::json timeline = nlohmann::json::array();
+};
+
+struct State {
+    bool connected = false;
+    bool slurperDown = false;
+    int latencyMs = 0;
+    std::set<int> mirrorsDown;
+};
+
+struct EndpointStats {
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+    uint64_t bytes = 0;
+};
+
+Scenario gScenario;
+Clock::time_point gStart;
+std::mutex gMutex;
+std::map<std::string, EndpointStats> gStats;
+std::mt19937 gRng(std::random_device {}());
+
+double secondsSinceStart()
+{
+    return std::chrono::duration<double>(Clock::now() - gStart).count();
+}
+
+Scenario loadScenario(const std::string& path)
+{
+    std::ifstream file(path);
+    auto json = nlohmann::json::parse(file);
+
+    Scenario scenario;
+    scenario.cid = json.value("cid", scenario.cid);
+    scenario.callsign = json.value("callsign", scenario.callsign);
+    scenario.frequency = json.value("frequency", scenario.frequency);
+    scenario.facility = json.value("facility", scenario.facility);
+    scenario.latitude = json.value("latitude", scenario.latitude);
+    scenario.longitude = json.value("longitude", scenario.longitude);
+    scenario.mirrors = json.value("mirrors", scenario.mirrors);
+    scenario.latencyMs = json.value("latency_ms", scenario.latencyMs);
+    scenario.errorRate = json.value("error_rate", scenario.errorRate);
+    scenario.slurperDown = json.value("slurper_down", scenario.slurperDown);
+    scenario.timeline
+        = json.value("timeline", nlohmann::json(nlohmann::json::array()));
+    return scenario;
+}
+
+// Replays the timeline up to now, so the state only depends on the clock
+State currentState()
+{
+    State state;
+    state.slurperDown = gScenario.slurperDown;
+    state.latencyMs = gScenario.latencyMs;
+    const double now = secondsSinceStart();
+
+    std::vector<nlohmann::json> events(
+        gScenario.timeline.begin(), gScenario.timeline.end());
+    std::stable_sort(events.begin(), events.end(),
+        [](const auto& a, const auto& b) {
+            return a.value("at", 0.0) < b.value("at", 0.0);
+        });
+
+    for (const auto& event : events) {
+        if (event.value("at", 0.0) > now) {
+            break;
+        }
+        if (event.contains("connected")) {
+            state.connected = event["connected"].get<bool>();
+        }
+        if (event.contains("slurper_down")) {
+            state.slurperDown = event["slurper_down"].get<bool>();
+        }
+        if (event.contains("latency_ms")) {
+            state.latencyMs = event["latency_ms"].get<int>();
+        }
+        if (event.contains("mirror_down")) {
+            state.mirrorsDown.insert(event["mirror_down"].get<int>());
+        }
+        if (event.contains("mirror_up")) {
+            state.mirrorsDown.erase(event["mirror_up"].get<int>());
+        }
+    }
+
+    return state;
+}
+
+// Applies the injected latency and errors, returns false if the request
+// should fail
+bool simulateNetwork(const std::string& endpoint, httplib::Response& res)
+{
+    const int latencyMs = currentState().latencyMs;
+    if (latencyMs > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(latencyMs));
+    }
+
+    std::uniform_real_distribution<double> roll(0.0, 1.0);
+    const std::lock_guard<std::mutex> l(gMutex);
+    gStats[endpoint].requests++;
+    if (roll(gRng) < gScenario.errorRate) {
+        gStats[endpoint].errors++;
+        res.status = 503;
+        return false;
+    }
+    return true;
+}
+
+void reply(const std::string& endpoint, httplib::Response& res,
+    const std::string& body, const char* contentType)
+{
+    {
+        const std::lock_guard<std::mutex> l(gMutex);
+        gStats[endpoint].bytes += body.size();
+    }
+    res.set_content(body, contentType);
+    std::printf("[%8.2fs] %s -> %d, %zu bytes\n", secondsSinceStart(),
+        endpoint.c_str(), res.status, body.size());
+}
+
+std::string buildDatafile(const State& state)
+{
+    nlohmann::json datafile;
+    datafile["general"]["update_timestamp"] = std::to_string(
+        std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+    datafile["pilots"] = nlohmann::json::array();
+    datafile["controllers"] = nlohmann::json::array();
+
+    if (state.connected) {
+        datafile["controllers"].push_back({ { "cid", gScenario.cid },
+            { "callsign", gScenario.callsign },
+            { "frequency", gScenario.frequency },
+            { "facility", gScenario.facility } });
+    }
+
+    return datafile.dump();
+}
+
+std::string buildSlurper(const State& state)
+{
+    if (!state.connected) {
+        return "";
+    }
+
+    return std::to_string(gScenario.cid) + "," + gScenario.callsign + ",atc,"
+        + gScenario.frequency + "," + std::to_string(gScenario.facility) + ","
+        + std::to_string(gScenario.latitude) + ","
+        + std::to_string(gScenario.longitude) + "\n";
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s scenario.json [port]\n", argv[0]);
+        return 1;
+    }
+
+    try {
+        gScenario = loadScenario(argv[1]);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "could not load scenario: %s\n", e.what());
+        return 1;
+    }
+
+    const int port = argc > 2 ? std::atoi(argv[2]) : 8080;
+    const std::string base = "http://127.0.0.1:" + std::to_string(port);
+
+    httplib::Server server;
+
+    server.Get("/status.json",
+        [&](const httplib::Request&, httplib::Response& res) {
+            if (!simulateNetwork("status", res)) {
+                return;
+            }
+
+            nlohmann::json status;
+            status["data"]["v3"] = nlohmann::json::array();
+            for (int i = 0; i < gScenario.mirrors; i++) {
+                status["data"]["v3"].push_back(
+                    base + "/mirror" + std::to_string(i) + "/vatsim-data.json");
+            }
+            reply("status", res, status.dump(), "application/json");
+        });
+
+    server.Get(R"(/mirror(\d+)/vatsim-data.json)",
+        [&](const httplib::Request& req, httplib::Response& res) {
+            const int mirror = std::stoi(req.matches[1]);
+            const auto endpoint = "mirror" + std::to_string(mirror);
+            if (!simulateNetwork(endpoint, res)) {
+                return;
+            }
+
+            auto state = currentState();
+            if (state.mirrorsDown.count(mirror) > 0) {
+                res.status = 503;
+                reply(endpoint, res, "", "text/plain");
+                return;
+            }
+            reply(endpoint, res, buildDatafile(state), "application/json");
+        });
+
+    server.Get("/users/info/",
+        [&](const httplib::Request& req, httplib::Response& res) {
+            if (!simulateNetwork("slurper", res)) {
+                return;
+            }
+
+            if (currentState().slurperDown) {
+                res.status = 503;
+                reply("slurper", res, "", "text/plain");
+                return;
+            }
+
+            if (!req.has_param("cid")) {
+                reply("slurper", res, "Must Provide CID", "text/plain");
+                return;
+            }
+
+            auto state = currentState();
+            if (req.get_param_value("cid") != std::to_string(gScenario.cid)) {
+                state.connected = false;
+            }
+            reply("slurper", res, buildSlurper(state), "text/plain");
+        });
+
+    gStart = Clock::now();
+
+    // Log state changes as they happen, with the time they happened at
+    std::atomic<bool> running = true;
+    std::thread watcher([&]() {
+        State last;
+        auto lastSummary = Clock::now();
+        while (running) {
+            auto state = currentState();
+            if (state.connected != last.connected) {
+                std::printf("[%8.2fs] client %s\n", secondsSinceStart(),
+                    state.connected ? "CONNECTED" : "DISCONNECTED");
+            }
+            if (state.slurperDown != last.slurperDown) {
+                std::printf("[%8.2fs] slurper %s\n", secondsSinceStart(),
+                    state.slurperDown ? "DOWN" : "UP");
+            }
+            if (state.mirrorsDown != last.mirrorsDown) {
+                std::printf("[%8.2fs] %zu mirror(s) down\n",
+                    secondsSinceStart(), state.mirrorsDown.size());
+            }
+            last = state;
+
+            if (Clock::now() - lastSummary > std::chrono::seconds(30)) {
+                lastSummary = Clock::now();
+                const std::lock_guard<std::mutex> l(gMutex);
+                for (const auto& [endpoint, stats] : gStats) {
+                    std::printf("[%8.2fs] %s: %llu requests, %llu errors, "
+                                "%llu bytes\n",
+                        secondsSinceStart(), endpoint.c_str(),
+                        static_cast<unsigned long long>(stats.requests),
+                        static_cast<unsigned long long>(stats.errors),
+                        static_cast<unsigned long long>(stats.bytes));
+                }
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    });
+
+    std::printf("Serving %s on %s\n", argv[1], base.c_str());
+    server.listen("127.0.0.1", port);
+
+    running = false;
+    watcher.join();
+    return 0;
+}
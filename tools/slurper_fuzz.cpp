@@ -0,0 +1,132 @@
+// Fuzzes the slurper parser.
+//
+// Built with clang, this is a libFuzzer target run against the seed corpus:
+//
+//   slurper_fuzz -max_total_time=60 ../tools/corpus/slurper
+//
+// Any other compiler builds a driver that replays the given files, or every
+// file of the given directories, once. That is enough to check the corpus
+// still parses under sanitizers.
+//
+// Every field handed out must lie within the input and the numeric parsers
+// must never read past their field, an out of bounds read aborts.
+
+#include "vatsim/slurper_parser.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+#ifndef VECTOR_LIBFUZZER
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#endif
+
+using vector_audio::vatsim::SlurperEntry;
+using vector_audio::vatsim::SlurperParser;
+
+namespace {
+void checkWithin(std::string_view input, std::string_view field)
+{
+    if (field.empty()) {
+        return;
+    }
+    if (field.data() < input.data()
+        || field.data() + field.size() > input.data() + input.size()) {
+        std::abort();
+    }
+}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    const std::string_view input(reinterpret_cast<const char*>(data), size);
+
+    std::string_view remaining = input;
+    std::string_view line;
+    SlurperEntry entry;
+    while (SlurperParser::nextLine(remaining, line)) {
+        checkWithin(input, line);
+        if (!SlurperParser::splitLine(line, entry)) {
+            continue;
+        }
+
+        for (auto field : { entry.cid, entry.callsign, entry.type,
+                 entry.frequency, entry.facility, entry.latitude,
+                 entry.longitude }) {
+            checkWithin(line, field);
+        }
+
+        int frequency = 0;
+        double lat = 0;
+        double lon = 0;
+        SlurperParser::parseFrequencyKhz(entry.frequency, frequency);
+        SlurperParser::parseDouble(entry.latitude, lat);
+        SlurperParser::parseDouble(entry.longitude, lon);
+        SlurperParser::hasTransmittingSuffix(entry.callsign);
+        SlurperParser::endsWith(entry.callsign, "_ATIS");
+    }
+
+    return 0;
+}
+
+#ifndef VECTOR_LIBFUZZER
+namespace {
+void replay(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const auto input = buffer.str();
+    LLVMFuzzerTestOneInput(
+        reinterpret_cast<const uint8_t*>(input.data()), input.size());
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s corpus_dir_or_file...\n", argv[0]);
+        return 1;
+    }
+
+    int replayed = 0;
+    for (int i = 1; i < argc; i++) {
+        const std::filesystem::path path(argv[i]);
+        std::error_code ec;
+        if (std::filesystem::is_directory(path, ec)) {
+            for (const auto& entry :
+                std::filesystem::directory_iterator(path, ec)) {
+                if (entry.is_regular_file(ec)) {
+                    replay(entry.path());
+                    replayed++;
+                }
+            }
+        } else if (std::filesystem::is_regular_file(path, ec)) {
+            replay(path);
+            replayed++;
+        } else {
+            std::fprintf(stderr, "%s: not a file or directory\n", argv[i]);
+            return 1;
+        }
+
+        if (ec) {
+            std::fprintf(
+                stderr, "%s: %s\n", argv[i], ec.message().c_str());
+            return 1;
+        }
+    }
+
+    if (replayed == 0) {
+        std::fprintf(stderr, "No inputs found\n");
+        return 1;
+    }
+
+    std::printf("Replayed %d inputs\n", replayed);
+    return 0;
+}
+#endif
@@ -0,0 +1,457 @@
+// Benchmarks the VATSIM data path against synthetic event-night payloads.
+//
+//   vector_audio_bench [iterations] [path/to/airports.json]
+//
+// Reports throughput, heap allocations per run and peak RSS for the
+// datafile parser and index, slurper parsing, pilot lookups and the airport
+// database loaders. Without an airports.json path, a synthetic database of
+// the same size as the bundled one is used.
+
+#include "ns/airport.h"
+#include "ns/airport_grid.h"
+#include "ns/airport_index.h"
+#include "vatsim/datafile_parser.h"
+#include "vatsim/datafile_snapshot.h"
+#include "vatsim/slurper_parser.h"
+
+#include <absl/strings/match.h>
+#include <absl/strings/str_split.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Count every heap allocation made by the process. GCC does not see that
+// operator delete is replaced as well and flags the free() calls
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace {
+std::atomic<uint64_t> gAllocations { 0 };
+}
+
+void* operator new(size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t /*size*/) noexcept { std::free(p); }
+
+namespace {
+using namespace vector_audio::vatsim;
+using Clock = std::chrono::steady_clock;
+
+constexpr int kControllers = 2500;
+constexpr int kPilots = 12000;
+constexpr int kAirports = 28000;
+constexpr size_t kChunkSize = 16 * 1024;
+
+const std::vector<std::string> kSuffixes
+    = { "_DEL", "_GND", "_TWR", "_APP", "_CTR", "_FSS", "_ATIS", "_OBS" };
+
+std::string randomIcao(std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> letter('A', 'Z');
+    std::string icao(4, 'A');
+    for (auto& c : icao) {
+        c = static_cast<char>(letter(rng));
+    }
+    return icao;
+}
+
+std::string generateDatafile(std::vector<std::string>& pilotCallsigns)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> lat(-80.0, 80.0);
+    std::uniform_real_distribution<double> lon(-180.0, 180.0);
+    std::uniform_int_distribution<int> cid(800000, 1700000);
+    std::uniform_int_distribution<int> khz(118000, 136975);
+
+    nlohmann::json datafile;
+    datafile["general"] = { { "version", 3 }, { "reload", 1 },
+        { "update", "20240101000000" },
+        { "update_timestamp", "2024-01-01T00:00:00.0000000Z" },
+        { "connected_clients", kControllers + kPilots },
+        { "unique_users", kControllers + kPilots } };
+
+    auto& pilots = datafile["pilots"] = nlohmann::json::array();
+    for (int i = 0; i < kPilots; i++) {
+        auto callsign = "AFR" + std::to_string(1000 + i);
+        pilotCallsigns.push_back(callsign);
+        pilots.push_back({ { "cid", cid(rng) }, { "name", "Pilot Name" },
+            { "callsign", callsign }, { "server", "GERMANY" },
+            { "pilot_rating", 0 }, { "military_rating", 0 },
+            { "latitude", lat(rng) }, { "longitude", lon(rng) },
+            { "altitude", 35000 }, { "groundspeed", 450 },
+            { "transponder", "2000" }, { "heading", 90 },
+            { "qnh_i_hg", 29.92 }, { "qnh_mb", 1013 },
+            { "flight_plan",
+                { { "flight_rules", "I" },
+                    { "aircraft", "A320/M-SDE2E3FGHIJ1RWXY/LB1" },
+                    { "aircraft_faa", "A320/L" }, { "aircraft_short", "A320" },
+                    { "departure", randomIcao(rng) },
+                    { "arrival", randomIcao(rng) },
+                    { "alternate", randomIcao(rng) },
+                    { "cruise_tas", "450" }, { "altitude", "35000" },
+                    { "deptime", "1200" }, { "enroute_time", "0130" },
+                    { "fuel_time", "0300" },
+                    { "remarks",
+                        "PBN/A1B1C1D1L1O1S1 DOF/240101 RMK/TCAS /V/" },
+                    { "route", "DCT ABCDE UN123 FGHIJ UL456 KLMNO DCT" },
+                    { "revision_id", 1 },
+                    { "assigned_transponder", "0000" } } },
+            { "logon_time", "2024-01-01T00:00:00.0000000Z" },
+            { "last_updated", "2024-01-01T00:00:00.0000000Z" } });
+    }
+
+    auto& controllers = datafile["controllers"] = nlohmann::json::array();
+    for (int i = 0; i < kControllers; i++) {
+        auto callsign = randomIcao(rng) + kSuffixes[i % kSuffixes.size()];
+        char frequency[16];
+        std::snprintf(frequency, sizeof(frequency), "%d.%03d", khz(rng) / 1000,
+            khz(rng) % 1000);
+        controllers.push_back({ { "cid", cid(rng) },
+            { "name", "Controller Name" }, { "callsign", callsign },
+            { "frequency", frequency }, { "facility", i % 7 },
+            { "rating", 5 }, { "server", "UK" }, { "visual_range", 50 },
+            { "text_atis",
+                { "Line one of the controller info",
+                    "Line two of the controller info" } },
+            { "last_updated", "2024-01-01T00:00:00.0000000Z" },
+            { "logon_time", "2024-01-01T00:00:00.0000000Z" } });
+    }
+
+    datafile["atis"] = nlohmann::json::array();
+    datafile["servers"] = nlohmann::json::array();
+    datafile["prefiles"] = nlohmann::json::array();
+    datafile["facilities"] = nlohmann::json::array();
+    datafile["ratings"] = nlohmann::json::array();
+
+    return datafile.dump();
+}
+
+std::string generateSlurper()
+{
+    std::mt19937 rng(43);
+    std::uniform_real_distribution<double> lat(-80.0, 80.0);
+    std::uniform_real_distribution<double> lon(-180.0, 180.0);
+
+    std::string body;
+    for (int i = 0; i < kControllers + kPilots; i++) {
+        const bool pilot = i >= kControllers;
+        auto callsign = pilot
+            ? "AFR" + std::to_string(1000 + i)
+            : randomIcao(rng) + kSuffixes[i % kSuffixes.size()];
+        body += std::to_string(800000 + i) + "," + callsign
+            + (pilot ? ",pilot,,," : ",atc,118.650,5,")
+            + std::to_string(lat(rng)) + "," + std::to_string(lon(rng))
+            + "\r\n";
+    }
+    return body;
+}
+
+std::string generateAirports()
+{
+    std::mt19937 rng(44);
+    std::uniform_real_distribution<double> lat(-80.0, 80.0);
+    std::uniform_real_distribution<double> lon(-180.0, 180.0);
+
+    nlohmann::json airports;
+    for (int i = 0; i < kAirports; i++) {
+        auto icao = randomIcao(rng);
+        airports[icao] = { { "icao", icao }, { "iata", "" },
+            { "name", "Some Airport" }, { "city", "Some City" },
+            { "state", "Some State" }, { "country", "XX" },
+            { "elevation", 300 }, { "lat", lat(rng) }, { "lon", lon(rng) },
+            { "tz", "Europe/Paris" } };
+    }
+    return airports.dump();
+}
+
+size_t peakRssKb()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss) / 1024; // Bytes on macOS
+#else
+    return static_cast<size_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+// Feeds the parser as the network would
+void feedInChunks(DatafileStreamParser& parser, const std::string& data)
+{
+    for (size_t i = 0; i < data.size(); i += kChunkSize) {
+        if (!parser.feed(
+                data.data() + i, std::min(kChunkSize, data.size() - i))) {
+            return;
+        }
+    }
+}
+
+// Runs fn the given number of times and prints the averages
+void bench(const char* name, int iterations, size_t bytes,
+    const std::function<void()>& fn)
+{
+    fn(); // Warm up
+
+    const auto allocationsBefore = gAllocations.load();
+    const auto t1 = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        fn();
+    }
+    const auto elapsed = std::chrono::duration<double>(Clock::now() - t1);
+    const auto allocations = gAllocations.load() - allocationsBefore;
+
+    const double perRunMs = elapsed.count() * 1000.0 / iterations;
+    std::printf("%-32s %10.3f ms/run", name, perRunMs);
+    if (bytes > 0) {
+        std::printf(" %10.1f MB/s",
+            static_cast<double>(bytes) * iterations / elapsed.count()
+                / (1024.0 * 1024.0));
+    } else {
+        std::printf(" %16s", "");
+    }
+    std::printf(" %12.1f allocs/run\n",
+        static_cast<double>(allocations) / iterations);
+}
+}
+
+int main(int argc, char** argv)
+{
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 10;
+
+    std::vector<std::string> pilotCallsigns;
+    const auto datafile = generateDatafile(pilotCallsigns);
+    const auto slurper = generateSlurper();
+
+    std::string airports;
+    if (argc > 2) {
+        std::ifstream file(argv[2]);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        airports = buffer.str();
+    } else {
+        airports = generateAirports();
+    }
+
+    std::printf("Datafile: %.1f MB, %d controllers, %d pilots\n",
+        static_cast<double>(datafile.size()) / (1024.0 * 1024.0), kControllers,
+        kPilots);
+    std::printf("Slurper: %.1f MB, airports: %.1f MB, %d iterations\n\n",
+        static_cast<double>(slurper.size()) / (1024.0 * 1024.0),
+        static_cast<double>(airports.size()) / (1024.0 * 1024.0), iterations);
+
+    using Section = DatafileStreamParser::Section;
+
+    // What the session watcher does, controllers only
+    bench("datafile scan (controllers)", iterations, datafile.size(), [&]() {
+        size_t found = 0;
+        DatafileStreamParser parser({ Section::kControllers },
+            [&](Section, std::string_view element) {
+                DatafileRecord record;
+                found += DatafileStreamParser::parseRecord(element, record);
+                return true;
+            });
+        feedInChunks(parser, datafile);
+        if (found != kControllers) {
+            std::abort();
+        }
+    });
+
+    // What the session watcher publishes when it is not connected, the whole
+    // controllers section but no pilots
+    bench("datafile snapshot (session)", iterations, datafile.size(), [&]() {
+        auto session = std::make_shared<DatafileSnapshot>(
+            std::chrono::seconds(15), false);
+        DatafileStreamParser parser(
+            { Section::kGeneral, Section::kControllers },
+            [&](Section section, std::string_view element) {
+                return session->addElement(section, element);
+            });
+        feedInChunks(parser, datafile);
+        if (session->controllerCount() != kControllers) {
+            std::abort();
+        }
+    });
+
+    // What a pilot lookup needs indexed
+    std::shared_ptr<DatafileSnapshot> snapshot;
+    bench("datafile snapshot (pilots)", iterations, datafile.size(), [&]() {
+        snapshot = std::make_shared<DatafileSnapshot>(
+            std::chrono::seconds(15), true);
+        DatafileStreamParser parser(
+            { Section::kGeneral, Section::kPilots, Section::kControllers },
+            [&](Section section, std::string_view element) {
+                return snapshot->addElement(section, element);
+            });
+        feedInChunks(parser, datafile);
+    });
+
+    // Reference point, what a plain DOM parse of the same file costs
+    bench("datafile nlohmann DOM", iterations, datafile.size(),
+        [&]() { auto json = nlohmann::json::parse(datafile); });
+
+    bench("pilot lookups (x10000)", iterations, 0, [&]() {
+        size_t found = 0;
+        for (int i = 0; i < 10000; i++) {
+            found += snapshot->findPilot(
+                         pilotCallsigns[i % pilotCallsigns.size()])
+                != nullptr;
+        }
+        if (found != 10000) {
+            std::abort();
+        }
+    });
+
+    bench("slurper parse", iterations, slurper.size(), [&]() {
+        std::string_view data = slurper;
+        std::string_view line;
+        SlurperEntry entry;
+        size_t transmitting = 0;
+        while (SlurperParser::nextLine(data, line)) {
+            if (!SlurperParser::splitLine(line, entry)) {
+                continue;
+            }
+
+            int frequency = 0;
+            double lat = 0;
+            double lon = 0;
+            SlurperParser::parseFrequencyKhz(entry.frequency, frequency);
+            SlurperParser::parseDouble(entry.latitude, lat);
+            SlurperParser::parseDouble(entry.longitude, lon);
+            transmitting += entry.type == "atc"
+                && SlurperParser::hasTransmittingSuffix(entry.callsign);
+        }
+        if (transmitting == 0) {
+            std::abort();
+        }
+    });
+
+    // Reference point, how the slurper was split before SlurperParser
+    bench("slurper absl split", iterations, slurper.size(), [&]() {
+        size_t transmitting = 0;
+        for (const auto& line : absl::StrSplit(slurper, '\n')) {
+            if (line.empty()) {
+                continue;
+            }
+
+            std::vector<std::string> res = absl::StrSplit(line, ',');
+            if (res.size() < 7) {
+                continue;
+            }
+
+            std::string frequency = res[3];
+            frequency.erase(
+                std::remove(frequency.begin(), frequency.end(), '.'),
+                frequency.end());
+            int khz = std::atoi(frequency.c_str()) * 1000;
+            double lat = std::atof(res[5].c_str());
+            double lon = std::atof(res[6].c_str());
+            (void)khz;
+            (void)lat;
+            (void)lon;
+
+            auto allowedYx = { "_CTR", "_APP", "_TWR", "_GND", "_DEL", "_FSS",
+                "_SUP", "_RDO", "_RMP", "_TMU", "_FMP" };
+            for (const auto& yxTest : allowedYx) {
+                if (absl::EndsWith(res[1], yxTest)) {
+                    transmitting += res[2] == "atc";
+                    break;
+                }
+            }
+        }
+        if (transmitting == 0) {
+            std::abort();
+        }
+    });
+
+    bench("airport database", iterations, airports.size(), [&]() {
+        std::istringstream in(airports);
+        auto all = ns::Airport::parseDatabase(in);
+        if (all.empty()) {
+            std::abort();
+        }
+    });
+
+    std::istringstream airportsIn(airports);
+    const auto allAirports = ns::Airport::parseDatabase(airportsIn);
+    const std::string indexPath = "vector_audio_bench_airports.bin";
+    if (ns::AirportIndex::write(indexPath, allAirports) < 0) {
+        std::abort();
+    }
+
+    bench("airport index open", iterations, 0, [&]() {
+        ns::AirportIndex index;
+        if (!index.open(indexPath) || index.size() == 0) {
+            std::abort();
+        }
+    });
+
+    ns::AirportIndex index;
+    index.open(indexPath);
+    bench("airport index lookups", iterations, 0, [&]() {
+        size_t found = 0;
+        for (const auto& [icao, airport] : allAirports) {
+            found += index.find(icao).has_value();
+        }
+        if (found == 0) {
+            std::abort();
+        }
+    });
+    index.close();
+    std::remove(indexPath.c_str());
+
+    ns::AirportGrid grid;
+    bench("airport grid build", iterations, 0, [&]() {
+        std::vector<ns::Airport> list;
+        list.reserve(allAirports.size());
+        for (const auto& [icao, airport] : allAirports) {
+            list.push_back(airport);
+        }
+        grid.build(std::move(list));
+    });
+
+    bench("nearest airport lookups", iterations, 0, [&]() {
+        size_t found = 0;
+        for (const auto& [icao, airport] : allAirports) {
+            found += grid.nearest(airport.lat + 0.1, airport.lon + 0.1, 50.0)
+                         .has_value();
+        }
+        if (found == 0) {
+            std::abort();
+        }
+    });
+
+    std::printf("\nPeak RSS: %zu KB\n", peakRssKb());
+    return 0;
+}